@@ -23,6 +23,8 @@
 #include <string>
 #include <cmath>
 
+#include "quadratic.h"
+
 // ----------------------------------------------------- Window / timing
 static const int  InitialWidth = 1280;
 static const int  InitialHeight = 720;
@@ -289,6 +291,95 @@ public:
 
 static FizziksWorld world;
 
+// ----------------------------------------------------- Trajectory preview
+// Arc of a circle launched from start with the current speed/angle/gravity,
+// in closed form. Bodies here step position before velocity, which gives
+// exactly
+//     p(t) = p0 + v0 t + 1/2 g t (t - dt)     at t = n dt
+// so the preview lands on the same points the simulation will. The first
+// contact with a halfspace (signed distance == radius) is the smallest
+// positive root of a quadratic in t, so no stepping is needed. Only
+// recomputed when one of the inputs changes.
+static const int PREVIEW_POINTS = 64;
+
+struct TrajectoryPreview {
+    // inputs of the cached arc
+    float   speed = -1.0f;
+    float   angleDeg = 0.0f;
+    Vector2 start{ 0, 0 };
+    Vector2 gravity{ 0, 0 };
+    int     halfspaces = -1;
+    int     screenW = 0, screenH = 0;   // set where cleanup deletes the body
+
+    Vector2 points[PREVIEW_POINTS];
+    int     count = 0;
+    bool    hit = false;
+    Vector2 hitPoint{ 0, 0 };
+};
+
+static TrajectoryPreview preview;
+
+static void UpdateTrajectoryPreview(Vector2 start, float radius)
+{
+    Vector2 g = world.accelerationGravity;
+
+    int halfspaceCount = 0;
+    for (auto* o : world.objekts) if (o->Shape() == HALF_SPACE) ++halfspaceCount;
+
+    if (preview.speed == speed && preview.angleDeg == angleDeg &&
+        preview.start.x == start.x && preview.start.y == start.y &&
+        preview.gravity.x == g.x && preview.gravity.y == g.y &&
+        preview.halfspaces == halfspaceCount &&
+        preview.screenW == GetScreenWidth() && preview.screenH == GetScreenHeight()) return;
+
+    preview.speed = speed;
+    preview.angleDeg = angleDeg;
+    preview.start = start;
+    preview.gravity = g;
+    preview.halfspaces = halfspaceCount;
+    preview.screenW = GetScreenWidth();
+    preview.screenH = GetScreenHeight();
+
+    Vector2 v0 = { speed * cosf(angleDeg * DEG2RAD), -speed * sinf(angleDeg * DEG2RAD) };
+
+    // p(t) = start + b t + a t^2 with the Euler lag folded into b
+    Vector2 a = Vector2Scale(g, 0.5f);
+    Vector2 b = Vector2Subtract(v0, Vector2Scale(g, 0.5f * dt));
+
+    // Ends where cleanupOffscreen would delete the body...
+    float tEnd = 30.0f;
+    const float lo[2] = { -200.0f, -200.0f };
+    const float hi[2] = { (float)GetScreenWidth() + 200.0f, (float)GetScreenHeight() + 200.0f };
+    const float pa[2] = { a.x, a.y }, pb[2] = { b.x, b.y }, p0[2] = { start.x, start.y };
+    for (int axis = 0; axis < 2; ++axis) {
+        float t = FirstPositiveRoot(pa[axis], pb[axis], p0[axis] - lo[axis]);
+        if (t > 0.0f && t < tEnd) tEnd = t;
+        t = FirstPositiveRoot(pa[axis], pb[axis], p0[axis] - hi[axis]);
+        if (t > 0.0f && t < tEnd) tEnd = t;
+    }
+
+    // ...or at the first halfspace it touches: dot(p(t) - P, n) = radius
+    preview.hit = false;
+    for (auto* o : world.objekts) {
+        if (o->Shape() != HALF_SPACE) continue;
+        auto* h = (FizziksHalfspace*)o;
+        Vector2 n = h->getNormal();
+        float c = Vector2Dot(Vector2Subtract(start, h->position), n) - radius;
+        float t = c <= 0.0f ? 0.0f : FirstPositiveRoot(Vector2Dot(a, n), Vector2Dot(b, n), c);
+        if (t >= 0.0f && t < tEnd) {
+            tEnd = t;
+            preview.hit = true;
+        }
+    }
+
+    preview.count = PREVIEW_POINTS;
+    for (int i = 0; i < PREVIEW_POINTS; ++i) {
+        float t = tEnd * i / (PREVIEW_POINTS - 1);
+        preview.points[i] = Vector2Add(start, Vector2Add(Vector2Scale(b, t), Vector2Scale(a, t * t)));
+    }
+    preview.hitPoint = preview.points[PREVIEW_POINTS - 1];
+}
+
 // ----------------------------------------------------- Per-frame update/draw
 static void updateFrame()
 {
@@ -331,6 +422,12 @@ static void drawFrame()
     Vector2 v = { speed * cosf(angleDeg * DEG2RAD), -speed * sinf(angleDeg * DEG2RAD) };
     DrawLineEx(startPos, Vector2Add(startPos, v), 3.0f, RED);
 
+    // Predicted arc (one batched line strip) and first halfspace contact
+    float spawnRadius = FizziksCircle().radius;
+    UpdateTrajectoryPreview(startPos, spawnRadius);
+    DrawLineStrip(preview.points, preview.count, Fade(YELLOW, 0.7f));
+    if (preview.hit) DrawCircleLinesV(preview.hitPoint, spawnRadius, YELLOW);
+
     world.draw();
 
     EndDrawing();
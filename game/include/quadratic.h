@@ -0,0 +1,24 @@
+#pragma once
+
+// Closed-form helpers shared by the launch-arc previews (week3, Week 9)
+
+#include <math.h>
+
+// Smallest root t > 0 of a t^2 + b t + c = 0, or -1 if there is none
+static inline float FirstPositiveRoot(float a, float b, float c)
+{
+    if (fabsf(a) < 1e-6f) {
+        if (fabsf(b) < 1e-6f) return -1.0f;
+        float t = -c / b;
+        return t > 0.0f ? t : -1.0f;
+    }
+    float disc = b * b - 4.0f * a * c;
+    if (disc < 0.0f) return -1.0f;
+    float sq = sqrtf(disc);
+    float t0 = (-b - sq) / (2.0f * a);
+    float t1 = (-b + sq) / (2.0f * a);
+    if (t0 > t1) { float tmp = t0; t0 = t1; t1 = tmp; }
+    if (t0 > 0.0f) return t0;
+    if (t1 > 0.0f) return t1;
+    return -1.0f;
+}
@@ -2,11 +2,12 @@
 /*
   GAME2005 – Physics mini-framework
   Week 11: Kinetic Friction on Halfspace
-  - Shapes: Circle, Halfspace (plane in 2D)
+  - Shapes: Circle, Halfspace (plane in 2D), convex Polygon / box
   - Forces: gravity, normal, kinetic friction (F = μN)
   - Response: translate out of overlap; respect static objects (“Fix”)
   - Visuals: draw force vectors (gravity, normal, friction) plus velocity
   - GUI: ground angle, gravity Y
+  - View: Camera2D pan/zoom over a fixed world domain (FizziksWorld::bounds)
   - 4 spheres with different masses and coefficients of friction
 
   Student: Aathiththan Yogeswaran 101462564
@@ -14,6 +15,7 @@
 
 #include "raylib.h"
 #include "raymath.h"
+#include "rlgl.h"
 
 // Include RayGUI 
 #define RAYGUI_IMPLEMENTATION
@@ -22,6 +24,18 @@
 #include <vector>
 #include <string>
 #include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 //   Window / timing
 static const int  InitialWidth = 1280;
@@ -40,31 +54,216 @@ static float groundAngleDeg = 0.0f;             // 0 = horizontal
 //   Helpers
 static inline float Vector2Dot(Vector2 a, Vector2 b) { return a.x * b.x + a.y * b.y; }
 
+//   Collision layers (bit flags for FizziksObjekt::category / mask)
+static const unsigned int LAYER_DEFAULT = 1u << 0;
+static const unsigned int LAYER_GROUND  = 1u << 1;
+static const unsigned int LAYER_SENSOR  = 1u << 2;
+static const unsigned int LAYER_DEBRIS  = 1u << 3;
+static const unsigned int LAYER_ALL     = 0xFFFFFFFFu;
+
 //   Shape enum
 enum FizziksShape
 {
     CIRCLE,
-    HALF_SPACE
+    HALF_SPACE,
+    POLYGON,
+    TERRAIN
+};
+
+//   Memory accounting
+// Fizziks memory is tagged with the subsystem that owns it: containers use
+// FizziksVector<T, tag> (a std::vector with a counting allocator) and bodies
+// count through FizziksObjekt's operator new, or by the chunk for the body
+// pools of circles and polygons. Current and peak bytes per tag
+// are relaxed atomics, so jobs may allocate too. Budgets are advisory: the
+// HUD flags a tag over its budget, nothing is refused.
+
+enum FizziksMemTag
+{
+    MEM_BODIES,         // body objects and the objekts list
+    MEM_SHAPES,         // polygon outlines, terrain, baked SDF
+    MEM_BROADPHASE,     // grid and the lists collected with it
+    MEM_CONTACTS,       // pairs, events, manifolds, axis cache
+    MEM_HISTORY,        // checkpoints and their descriptors
+    MEM_TRAILS,
+    MEM_PARTICLES,
+    MEM_RENDER,         // instances, labels, debug lines, snapshots
+    MEM_SCRATCH,        // frame arenas
+    MEM_TAG_COUNT
+};
+
+struct FizziksMemory {
+    static const char* name(FizziksMemTag tag) {
+        static const char* names[MEM_TAG_COUNT] = {
+            "bodies", "shapes", "broadphase", "contacts", "history", "trails", "particles", "render", "scratch"
+        };
+        return names[tag];
+    }
+
+    static void add(FizziksMemTag tag, size_t bytes) {
+        size_t now = current[tag].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        size_t high = peak[tag].load(std::memory_order_relaxed);
+        while (now > high && !peak[tag].compare_exchange_weak(high, now, std::memory_order_relaxed)) {}
+    }
+    static void sub(FizziksMemTag tag, size_t bytes) { current[tag].fetch_sub(bytes, std::memory_order_relaxed); }
+
+    static size_t currentBytes(FizziksMemTag tag) { return current[tag].load(std::memory_order_relaxed); }
+    static size_t peakBytes(FizziksMemTag tag) { return peak[tag].load(std::memory_order_relaxed); }
+    static size_t totalBytes() {
+        size_t n = 0;
+        for (int t = 0; t < MEM_TAG_COUNT; ++t) n += currentBytes((FizziksMemTag)t);
+        return n;
+    }
+
+    // 0 = no budget
+    static void setBudget(FizziksMemTag tag, size_t bytes) { budget[tag] = bytes; }
+    static size_t budgetBytes(FizziksMemTag tag) { return budget[tag]; }
+    static bool overBudget(FizziksMemTag tag) { return budget[tag] && currentBytes(tag) > budget[tag]; }
+
+private:
+    static inline std::atomic<size_t> current[MEM_TAG_COUNT] = {};
+    static inline std::atomic<size_t> peak[MEM_TAG_COUNT] = {};
+    static inline size_t budget[MEM_TAG_COUNT] = {};
+};
+
+template <typename T, FizziksMemTag Tag>
+struct FizziksAllocator {
+    using value_type = T;
+    template <typename U> struct rebind { using other = FizziksAllocator<U, Tag>; };
+
+    FizziksAllocator() = default;
+    template <typename U> FizziksAllocator(const FizziksAllocator<U, Tag>&) {}
+
+    T* allocate(size_t n) {
+        FizziksMemory::add(Tag, n * sizeof(T));
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n) {
+        FizziksMemory::sub(Tag, n * sizeof(T));
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U> bool operator==(const FizziksAllocator<U, Tag>&) const { return true; }
+    template <typename U> bool operator!=(const FizziksAllocator<U, Tag>&) const { return false; }
+};
+
+template <typename T, FizziksMemTag Tag>
+using FizziksVector = std::vector<T, FizziksAllocator<T, Tag>>;
+
+// Slots for the bodies of one type, in chunks, so bodies of that type sit
+// next to each other and FizziksWorld::sortBodies() can move their
+// contents into the order it steps them in. Freed slots are reused; the
+// chunks go back when the last body of the type does. Bodies are made on
+// the main thread and deleted on the simulation thread, hence the lock.
+template <typename T>
+struct FizziksBodyPool {
+    static void* alloc() {
+        State& st = state();
+        std::lock_guard<std::mutex> guard(st.lock);
+        if (!st.freeList) grow(st);
+        Slot* s = st.freeList;
+        st.freeList = s->next;
+        ++st.live;
+        return s;
+    }
+    static void free(void* p) {
+        State& st = state();
+        std::lock_guard<std::mutex> guard(st.lock);
+        Slot* s = (Slot*)p;
+        s->next = st.freeList;
+        st.freeList = s;
+        if (--st.live == 0) release(st);
+    }
+
+private:
+    union Slot {
+        Slot* next;
+        alignas(T) unsigned char bytes[sizeof(T)];
+    };
+    struct Chunk {
+        Chunk* next;
+        Slot slots[1024];
+    };
+    struct State {
+        std::mutex lock;
+        Slot*  freeList = nullptr;
+        Chunk* chunks = nullptr;
+        size_t live = 0;
+    };
+
+    // Never destroyed: static worlds delete their bodies at exit, after
+    // any static of ours would be gone
+    static State& state() {
+        static State* st = new State();
+        return *st;
+    }
+
+    static void grow(State& st) {
+        Chunk* chunk = (Chunk*)::operator new(sizeof(Chunk));
+        FizziksMemory::add(MEM_BODIES, sizeof(Chunk));
+        chunk->next = st.chunks;
+        st.chunks = chunk;
+        // Threaded so the first slot is handed out first
+        for (int i = (int)std::size(chunk->slots) - 1; i >= 0; --i) {
+            chunk->slots[i].next = st.freeList;
+            st.freeList = &chunk->slots[i];
+        }
+    }
+    static void release(State& st) {
+        while (st.chunks) {
+            Chunk* next = st.chunks->next;
+            ::operator delete(st.chunks);
+            FizziksMemory::sub(MEM_BODIES, sizeof(Chunk));
+            st.chunks = next;
+        }
+        st.freeList = nullptr;
+    }
 };
 
+struct FizziksObjekt;
+using FizziksObjektList = FizziksVector<FizziksObjekt*, MEM_BODIES>;
+
 //   Base object
 struct FizziksObjekt {
     bool     isStatic = false;               // "Fix" when true
+    bool     isSensor = false;               // overlap is reported, never resolved
+    bool     reportContacts = false;         // also report solid contacts as events
+    unsigned int category = LAYER_DEFAULT;   // layers this body is on
+    unsigned int mask = LAYER_ALL;           // layers it collides with
+    bool     hasExclusions = false;          // listed in FizziksWorld's pair exclusions
+    bool     baked = false;                  // static, circles hit it through the world's SDF
     Vector2  position{ 0, 0 };
     Vector2  velocity{ 0, 0 };
     float    mass = 1.0f;
-    std::string name = "objekt";
+    unsigned int id = 0;                     // numeric id
+    std::string name;                        // empty unless the body was given one
     Color    color = GREEN;                  // current color
     Color    baseColor = GREEN;              // original color to restore
+    Vector2  boundsMin{ 0, 0 };              // cached AABB, refreshed every step
+    Vector2  boundsMax{ 0, 0 };
+    unsigned int queryMark = 0;              // dedupe stamp for grid queries
 
     virtual ~FizziksObjekt() = default;
 
+    // Counted as MEM_BODIES; the sized delete gets the derived size through
+    // the virtual destructor. name stays inline (short string) for ids.
+    static void* operator new(size_t size) {
+        FizziksMemory::add(MEM_BODIES, size);
+        return ::operator new(size);
+    }
+    static void operator delete(void* p, size_t size) {
+        FizziksMemory::sub(MEM_BODIES, size);
+        ::operator delete(p);
+    }
+
     virtual void draw() {
         // Base draws nothing
     }
 
     virtual FizziksShape Shape() = 0;
 
+    virtual void updateBounds() { boundsMin = boundsMax = position; }
+
     void makeStatic(bool v = true) { isStatic = v; }
 };
 
@@ -80,26 +279,23 @@ struct FizziksCircle : public FizziksObjekt {
     void draw() override {
         // Sphere
         DrawCircleV(position, radius, Fade(color, 0.6f));
-        DrawText(name.c_str(), (int)(position.x - radius), (int)(position.y - radius * 2), 12, LIGHTGRAY);
-
-        // Velocity (red)
-        Vector2 velEnd = Vector2Add(position, Vector2Scale(velocity, 0.1f));
-        DrawLineEx(position, velEnd, 2.0f, RED);
-
-        // Gravity (purple)
-        Vector2 gEnd = Vector2Add(position, Vector2Scale(Fgravity, 0.02f));
-        DrawLineEx(position, gEnd, 2.0f, PURPLE);
-
-        // Normal (green)
-        Vector2 nEnd = Vector2Add(position, Vector2Scale(Fnormal, 0.02f));
-        DrawLineEx(position, nEnd, 2.0f, GREEN);
+    }
 
-        // Friction (orange)
-        Vector2 fEnd = Vector2Add(position, Vector2Scale(Ffriction, 0.02f));
-        DrawLineEx(position, fEnd, 2.0f, ORANGE);
+    void updateBounds() override {
+        boundsMin = Vector2{ position.x - radius, position.y - radius };
+        boundsMax = Vector2{ position.x + radius, position.y + radius };
     }
 
     FizziksShape Shape() override { return CIRCLE; }
+
+    // From the circle pool; a derived type of another size takes the heap
+    static void* operator new(size_t size) {
+        return size == sizeof(FizziksCircle) ? FizziksBodyPool<FizziksCircle>::alloc() : FizziksObjekt::operator new(size);
+    }
+    static void operator delete(void* p, size_t size) {
+        if (size == sizeof(FizziksCircle)) FizziksBodyPool<FizziksCircle>::free(p);
+        else FizziksObjekt::operator delete(p, size);
+    }
 };
 
 //   Halfspace (2D plane)
@@ -121,21 +317,250 @@ public:
     Vector2 getNormal()  const { return normal; }
 
     void draw() override {
-        // Mark a point on line
-        DrawCircleV(position, 6.0f, color);
+        draw(Rectangle{ 0, 0, (float)GetScreenWidth(), (float)GetScreenHeight() });
+    }
 
-        // Draw normal
-        DrawLineEx(position, Vector2Add(position, Vector2Scale(normal, 40.0f)), 2.0f, color);
+    // Draw only the part of the infinite line that lies inside view
+    void draw(Rectangle view) { draw(position, normal, color, view); }
+    static void draw(Vector2 position, Vector2 normal, Color color, Rectangle view) {
+        // Mark a point on line + normal, only when near the view
+        if (position.x > view.x - 40.0f && position.x < view.x + view.width + 40.0f &&
+            position.y > view.y - 40.0f && position.y < view.y + view.height + 40.0f) {
+            DrawCircleV(position, 6.0f, color);
+            DrawLineEx(position, Vector2Add(position, Vector2Scale(normal, 40.0f)), 2.0f, color);
+        }
 
-        // Draw infinite line: tangent is normal rotated by 90 degrees
+        // Infinite line p(t) = position + t * tangent, clipped to the view
+        // slabs (Liang-Barsky); tangent is normal rotated by 90 degrees
         Vector2 tangent = Vector2Rotate(normal, PI * 0.5f);
-        DrawLineEx(Vector2Add(position, Vector2Scale(tangent, -4000.0f)),
-            Vector2Add(position, Vector2Scale(tangent, 4000.0f)), 1.0f, color);
+        float tMin = -1e30f, tMax = 1e30f;
+        const float lo[2] = { view.x, view.y };
+        const float hi[2] = { view.x + view.width, view.y + view.height };
+        const float p[2] = { position.x, position.y };
+        const float t[2] = { tangent.x, tangent.y };
+        for (int axis = 0; axis < 2; ++axis) {
+            if (fabsf(t[axis]) < 1e-6f) {
+                if (p[axis] < lo[axis] || p[axis] > hi[axis]) return;     // parallel and outside
+                continue;
+            }
+            float t0 = (lo[axis] - p[axis]) / t[axis];
+            float t1 = (hi[axis] - p[axis]) / t[axis];
+            if (t0 > t1) { float tmp = t0; t0 = t1; t1 = tmp; }
+            if (t0 > tMin) tMin = t0;
+            if (t1 < tMax) tMax = t1;
+        }
+        if (tMin > tMax) return;                                            // misses the view
+
+        DrawLineEx(Vector2Add(position, Vector2Scale(tangent, tMin)),
+            Vector2Add(position, Vector2Scale(tangent, tMax)), 1.0f, color);
+    }
+
+    // Infinite: never culled, clipped at draw time instead
+    void updateBounds() override {
+        boundsMin = Vector2{ -1e30f, -1e30f };
+        boundsMax = Vector2{ 1e30f, 1e30f };
     }
 
     FizziksShape Shape() override { return HALF_SPACE; }
 };
 
+//   Convex polygon
+// Vertices are kept relative to position, with one outward unit normal per
+// edge (edge i runs from vertex i to i + 1). Both are fixed at setup, so the
+// SAT tests below only project. Polygons translate but do not rotate.
+struct FizziksPolygon : public FizziksObjekt {
+    FizziksVector<Vector2, MEM_SHAPES> local;
+    FizziksVector<Vector2, MEM_SHAPES> normals;
+
+    // Any convex outline, either winding. Stored in the order raylib fills
+    // triangles in (negative signed area with +Y down).
+    void setVertices(const Vector2* v, int n) {
+        local.assign(v, v + n);
+        float area2 = 0.0f;
+        for (int i = 0; i < n; ++i) {
+            Vector2 a = local[i], b = local[(i + 1) % n];
+            area2 += a.x * b.y - a.y * b.x;
+        }
+        if (area2 > 0.0f) std::reverse(local.begin(), local.end());
+
+        Vector2 centroid{ 0, 0 };
+        for (Vector2 p : local) centroid = Vector2Add(centroid, p);
+        centroid = Vector2Scale(centroid, 1.0f / n);
+
+        normals.resize(n);
+        for (int i = 0; i < n; ++i) {
+            Vector2 a = local[i], b = local[(i + 1) % n];
+            Vector2 e = Vector2Subtract(b, a);
+            Vector2 nrm = Vector2Normalize(Vector2{ e.y, -e.x });
+            if (Vector2Dot(nrm, Vector2Subtract(a, centroid)) < 0.0f) nrm = Vector2Negate(nrm);
+            normals[i] = nrm;
+        }
+    }
+
+    void setBox(float width, float height) {
+        float hw = width * 0.5f, hh = height * 0.5f;
+        const Vector2 box[4] = { { -hw, -hh }, { hw, -hh }, { hw, hh }, { -hw, hh } };
+        setVertices(box, 4);
+    }
+
+    int count() const { return (int)local.size(); }
+    Vector2 vertex(int i) const { return Vector2Add(position, local[i]); }
+
+    void draw() override {
+        int n = count();
+        for (int i = 1; i + 1 < n; ++i)
+            DrawTriangle(vertex(0), vertex(i), vertex(i + 1), Fade(color, 0.6f));
+        for (int i = 0; i < n; ++i)
+            DrawLineV(vertex(i), vertex(i + 1 < n ? i + 1 : 0), color);
+    }
+
+    // Same, from n world-space vertices
+    static void draw(const Vector2* v, int n, Color color) {
+        for (int i = 1; i + 1 < n; ++i)
+            DrawTriangle(v[0], v[i], v[i + 1], Fade(color, 0.6f));
+        for (int i = 0; i < n; ++i)
+            DrawLineV(v[i], v[i + 1 < n ? i + 1 : 0], color);
+    }
+
+    void updateBounds() override {
+        boundsMin = boundsMax = position;
+        if (local.empty()) return;
+        boundsMin = boundsMax = vertex(0);
+        for (int i = 1; i < count(); ++i) {
+            boundsMin = Vector2Min(boundsMin, vertex(i));
+            boundsMax = Vector2Max(boundsMax, vertex(i));
+        }
+    }
+
+    FizziksShape Shape() override { return POLYGON; }
+
+    // From the polygon pool (the outlines stay in their own vectors)
+    static void* operator new(size_t size) {
+        return size == sizeof(FizziksPolygon) ? FizziksBodyPool<FizziksPolygon>::alloc() : FizziksObjekt::operator new(size);
+    }
+    static void operator delete(void* p, size_t size) {
+        if (size == sizeof(FizziksPolygon)) FizziksBodyPool<FizziksPolygon>::free(p);
+        else FizziksObjekt::operator delete(p, size);
+    }
+};
+
+//   Static terrain: segment chain + BVH
+// A polyline in world coordinates (position is only an anchor). Its
+// segments are indexed by a bounding volume hierarchy built once in
+// setPoints(): nodes live in one flat array, the two children of an inner
+// node side by side, and leaves hold a short run of segment indices. A
+// circle only visits the nodes its AABB touches, so the cost per body grows
+// with log(segments). Like halfspaces, terrain stays out of the grid.
+struct FizziksTerrain : public FizziksObjekt {
+    struct Node {
+        Vector2 min, max;
+        int first;                      // leaf: into segments, inner: left child
+        int count;                      // segments in a leaf, 0 for inner nodes
+    };
+
+    FizziksVector<Vector2, MEM_SHAPES> points;
+    FizziksVector<int, MEM_SHAPES>     segments;      // segment i runs points[i] -> points[i + 1]
+    FizziksVector<Node, MEM_SHAPES>    nodes;       // nodes[0] is the root
+
+    FizziksTerrain() { isStatic = true; }
+
+    void setPoints(const Vector2* p, int n) {
+        points.assign(p, p + n);
+        position = n > 0 ? p[0] : Vector2{ 0, 0 };
+        segments.resize(n > 1 ? n - 1 : 0);
+        for (int i = 0; i < (int)segments.size(); ++i) segments[i] = i;
+        nodes.clear();
+        if (!segments.empty()) {
+            nodes.reserve(2 * segments.size());
+            nodes.push_back(Node{});
+            build(0, 0, (int)segments.size());
+        }
+        updateBounds();
+    }
+
+    // Calls visit(a, b) for every segment whose box overlaps [min, max]
+    template <typename F>
+    void query(Vector2 min, Vector2 max, F&& visit) const {
+        if (nodes.empty()) return;
+        int stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node& node = nodes[stack[--top]];
+            if (node.max.x < min.x || node.min.x > max.x || node.max.y < min.y || node.min.y > max.y) continue;
+            if (node.count > 0) {
+                for (int i = node.first; i < node.first + node.count; ++i)
+                    visit(points[segments[i]], points[segments[i] + 1]);
+            }
+            else {
+                stack[top++] = node.first;
+                stack[top++] = node.first + 1;
+            }
+        }
+    }
+
+    void draw() override {
+        for (size_t i = 0; i + 1 < points.size(); ++i) DrawLineV(points[i], points[i + 1], color);
+    }
+
+    // Only the segments inside view, straight from the BVH
+    void draw(Rectangle view) { draw(view, color); }
+    void draw(Rectangle view, Color color) const {
+        rlBegin(RL_LINES);
+        rlColor4ub(color.r, color.g, color.b, color.a);
+        query(Vector2{ view.x, view.y }, Vector2{ view.x + view.width, view.y + view.height }, [](Vector2 a, Vector2 b) {
+            rlVertex2f(a.x, a.y);
+            rlVertex2f(b.x, b.y);
+        });
+        rlEnd();
+    }
+
+    void updateBounds() override {
+        if (nodes.empty()) { boundsMin = boundsMax = position; return; }
+        boundsMin = nodes[0].min;
+        boundsMax = nodes[0].max;
+    }
+
+    FizziksShape Shape() override { return TERRAIN; }
+
+private:
+    static const int LEAF_SIZE = 4;
+
+    // Median split on the longer axis of the node's box
+    void build(int node, int begin, int end) {
+        Vector2 mn{ INFINITY, INFINITY }, mx{ -INFINITY, -INFINITY };
+        for (int i = begin; i < end; ++i) {
+            Vector2 a = points[segments[i]], b = points[segments[i] + 1];
+            mn = Vector2Min(mn, Vector2Min(a, b));
+            mx = Vector2Max(mx, Vector2Max(a, b));
+        }
+        nodes[node].min = mn;
+        nodes[node].max = mx;
+
+        if (end - begin <= LEAF_SIZE) {
+            nodes[node].first = begin;
+            nodes[node].count = end - begin;
+            return;
+        }
+
+        bool splitX = (mx.x - mn.x) >= (mx.y - mn.y);
+        int mid = (begin + end) / 2;
+        std::nth_element(segments.begin() + begin, segments.begin() + mid, segments.begin() + end, [&](int s, int t) {
+            float cs = splitX ? points[s].x + points[s + 1].x : points[s].y + points[s + 1].y;
+            float ct = splitX ? points[t].x + points[t + 1].x : points[t].y + points[t + 1].y;
+            return cs < ct;
+        });
+
+        int left = (int)nodes.size();
+        nodes.push_back(Node{});
+        nodes.push_back(Node{});
+        nodes[node].first = left;
+        nodes[node].count = 0;
+        build(left, begin, mid);
+        build(left + 1, mid, end);
+    }
+};
+
 //   Overlap tests
 static bool CircleCircleOverlap(FizziksCircle* a, FizziksCircle* b)
 {
@@ -203,283 +628,5037 @@ static void SeparateCircleHalfspace(FizziksCircle* c, FizziksHalfspace* h)
     }
 }
 
-//   World (polymorphic)
-
-struct FizziksWorld {
-private:
-    unsigned int objektCount = 0;
-
-public:
-    std::vector<FizziksObjekt*> objekts;
-    // gravity as acceleration (pixels/s^2), +Y down
-    Vector2 accelerationGravity{ 0, 300 };
-
-    ~FizziksWorld() {
-        for (auto* p : objekts) delete p;
-        objekts.clear();
-    }
+// Pushes a circle off one terrain segment (the terrain never moves)
+static bool SeparateCircleSegment(FizziksCircle* c, Vector2 a, Vector2 b)
+{
+    Vector2 ab = Vector2Subtract(b, a);
+    float len2 = Vector2Dot(ab, ab);
+    float t = len2 > 0.0f ? Clamp(Vector2Dot(Vector2Subtract(c->position, a), ab) / len2, 0.0f, 1.0f) : 0.0f;
+    Vector2 d = Vector2Subtract(c->position, Vector2Add(a, Vector2Scale(ab, t)));
+    float dist2 = Vector2Dot(d, d);
+    if (dist2 >= c->radius * c->radius) return false;
 
-    void add(FizziksObjekt* obj) {
-        obj->name = std::to_string(objektCount++);
-        objekts.push_back(obj);
+    float dist = sqrtf(dist2);
+    Vector2 n = dist > 0.0f ? Vector2Scale(d, 1.0f / dist) : Vector2Normalize(Vector2{ ab.y, -ab.x });
+    if (!c->isStatic) {
+        c->position = Vector2Add(c->position, Vector2Scale(n, c->radius - dist + EPS));
+        float vn = Vector2Dot(c->velocity, n);
+        if (vn < 0) c->velocity = Vector2Subtract(c->velocity, Vector2Scale(n, vn));
     }
+    return true;
+}
 
-    void update();
-
-    void checkCollisions();
-    void cleanupOffscreen();
+//   Polygon narrowphase (SAT)
+// A contact manifold has up to two points; normal points from A to B.
+// The polygon tests take the axis found last step (an edge index, -1 for
+// none) and try it first: a pair that was apart usually still is, and then
+// one projection settles it. The axis is written back for the next step.
 
-    void draw() {
-        for (auto* o : objekts) o->draw();
-    }
+struct FizziksManifold {
+    Vector2 normal;
+    float   penetration;
+    int     count;
+    Vector2 points[2];
 };
 
-static FizziksWorld world;
-static FizziksHalfspace* gGround = nullptr;  // main Halfspace used for friction
-
-//   World::update with forces
+// Axis ids for polygon pairs: edge index, plus this bit when the edge
+// belongs to the second polygon
+static const int SAT_AXIS_OF_B = 1 << 16;
 
-void FizziksWorld::update()
+// How far B lies in front of A's edge i (> 0: separated along it)
+static float PolygonEdgeSeparation(const FizziksPolygon* A, int i, const FizziksPolygon* B)
 {
-    dt = 1.0f / TARGET_FPS;
-    timeAccum += dt;
+    Vector2 n = A->normals[i];
+    Vector2 v = A->vertex(i);
+    float best = INFINITY;
+    for (int k = 0; k < B->count(); ++k)
+        best = fminf(best, Vector2Dot(Vector2Subtract(B->vertex(k), v), n));
+    return best;
+}
 
-    // restore colors every frame
-    for (auto* o : objekts) o->color = o->baseColor;
+static float MaxEdgeSeparation(const FizziksPolygon* A, const FizziksPolygon* B, int& edge)
+{
+    float best = -INFINITY;
+    edge = 0;
+    for (int i = 0; i < A->count(); ++i) {
+        float d = PolygonEdgeSeparation(A, i, B);
+        if (d > best) { best = d; edge = i; }
+        if (d > 0.0f) break;                // separating axis found
+    }
+    return best;
+}
 
-    // --- Force-based integration for circles ---
-    for (auto* o : objekts) {
-        if (o->isStatic) continue;
+// Keeps the part of segment [a, b] with dot(p, n) <= offset
+static int ClipSegment(Vector2 in[2], Vector2 out[2], Vector2 n, float offset)
+{
+    int count = 0;
+    float da = Vector2Dot(in[0], n) - offset;
+    float db = Vector2Dot(in[1], n) - offset;
+    if (da <= 0.0f) out[count++] = in[0];
+    if (db <= 0.0f) out[count++] = in[1];
+    if (da * db < 0.0f) out[count++] = Vector2Lerp(in[0], in[1], da / (da - db));
+    return count;
+}
 
-        if (o->Shape() == CIRCLE) {
-            auto* c = (FizziksCircle*)o;
+static bool CollidePolygons(const FizziksPolygon* A, const FizziksPolygon* B, int& axis, bool& cacheHit, FizziksManifold& m)
+{
+    cacheHit = false;
+    if (axis >= 0) {
+        const FizziksPolygon* P = (axis & SAT_AXIS_OF_B) ? B : A;
+        const FizziksPolygon* Q = (axis & SAT_AXIS_OF_B) ? A : B;
+        int edge = axis & (SAT_AXIS_OF_B - 1);
+        if (edge < P->count() && PolygonEdgeSeparation(P, edge, Q) > 0.0f) { cacheHit = true; return false; }
+    }
 
-            // Gravity force
-            Vector2 Fg = Vector2Scale(accelerationGravity, c->mass);
-            Vector2 Fn{ 0,0 };
-            Vector2 Ff{ 0,0 };
-
-            if (gGround) {
-                Vector2 n = gGround->getNormal();
-
-                // Check if close enough to be considered in contact
-                Vector2 toC = Vector2Subtract(c->position, gGround->position);
-                float   dSign = Vector2Dot(toC, n);
-                float   pen = c->radius - dSign;
-
-                if (pen >= -1.0f) { // slightly above still counts as resting on surface
-                    // Decompose gravity into normal + tangential components
-                    float gNmag = Vector2Dot(accelerationGravity, n);
-                    Vector2 gN = Vector2Scale(n, gNmag);
-                    Vector2 gT = Vector2Subtract(accelerationGravity, gN);
-
-                    // Normal force cancels component of gravity into plane
-                    Fn = Vector2Scale(n, -gNmag * c->mass);    // opposite direction
-                    float Nmag = Vector2Length(Fn);
-
-                    // Kinetic friction magnitude μN, opposite tangential gravity
-                    float gTlen = Vector2Length(gT);
-                    if (gTlen > 0.0001f && Nmag > 0.0f) {
-                        Vector2 dirOppose = Vector2Negate(Vector2Scale(gT, 1.0f / gTlen));
-                        float FfMag = c->kFriction * Nmag;
-                        Ff = Vector2Scale(dirOppose, FfMag);
-                    }
-                }
-            }
+    int edgeA, edgeB;
+    float sepA = MaxEdgeSeparation(A, B, edgeA);
+    if (sepA > 0.0f) { axis = edgeA; return false; }
+    float sepB = MaxEdgeSeparation(B, A, edgeB);
+    if (sepB > 0.0f) { axis = edgeB | SAT_AXIS_OF_B; return false; }
 
-            // Net force and acceleration
-            Vector2 Fnet = Vector2Add(Fg, Vector2Add(Fn, Ff));
-            Vector2 acc = Vector2Scale(Fnet, 1.0f / c->mass);
+    // Reference face: the shallower axis, biased towards A so it does not
+    // flip between frames when both are about equal
+    bool flip = sepB > sepA + 0.01f;
+    axis = flip ? (edgeB | SAT_AXIS_OF_B) : edgeA;
+    const FizziksPolygon* ref = flip ? B : A;
+    const FizziksPolygon* inc = flip ? A : B;
+    int e = flip ? edgeB : edgeA;
 
-            // Integrate
-            c->velocity = Vector2Add(c->velocity, Vector2Scale(acc, dt));
-            c->position = Vector2Add(c->position, Vector2Scale(c->velocity, dt));
+    Vector2 n = ref->normals[e];
+    Vector2 v1 = ref->vertex(e);
+    Vector2 v2 = ref->vertex(e + 1 < ref->count() ? e + 1 : 0);
 
-            // store for drawing
-            c->Fgravity = Fg;
-            c->Fnormal = Fn;
-            c->Ffriction = Ff;
-        }
-        else {
-            // default integration for any other dynamic objects
-            o->position = Vector2Add(o->position, Vector2Scale(o->velocity, dt));
-            o->velocity = Vector2Add(o->velocity, Vector2Scale(accelerationGravity, dt));
-        }
+    // Incident edge: the one facing most against the reference normal
+    int k = 0;
+    float most = INFINITY;
+    for (int i = 0; i < inc->count(); ++i) {
+        float d = Vector2Dot(inc->normals[i], n);
+        if (d < most) { most = d; k = i; }
     }
+    Vector2 incident[2] = { inc->vertex(k), inc->vertex(k + 1 < inc->count() ? k + 1 : 0) };
 
-    checkCollisions();
-    cleanupOffscreen();
+    // Clip it to the side planes of the reference edge
+    Vector2 t = Vector2Normalize(Vector2Subtract(v2, v1));
+    Vector2 clip1[2], clip2[2];
+    if (ClipSegment(incident, clip1, Vector2Negate(t), -Vector2Dot(v1, t)) < 2) return false;
+    if (ClipSegment(clip1, clip2, t, Vector2Dot(v2, t)) < 2) return false;
+
+    m.count = 0;
+    m.penetration = 0.0f;
+    for (Vector2 p : clip2) {
+        float depth = Vector2Dot(Vector2Subtract(p, v1), n);
+        if (depth > 0.0f) continue;
+        m.points[m.count++] = p;
+        m.penetration = fmaxf(m.penetration, -depth);
+    }
+    m.normal = flip ? Vector2Negate(n) : n;
+    return m.count > 0;
 }
 
-void FizziksWorld::checkCollisions()
+// Normal from the polygon to the circle
+static bool CollidePolygonCircle(const FizziksPolygon* P, const FizziksCircle* c, int& axis, bool& cacheHit, FizziksManifold& m)
 {
-    for (int i = 0; i < (int)objekts.size(); ++i) {
-        for (int j = i + 1; j < (int)objekts.size(); ++j) {
-            FizziksObjekt* A = objekts[i];
-            FizziksObjekt* B = objekts[j];
+    int n = P->count();
+    cacheHit = false;
+    if (axis >= 0 && axis < n &&
+        Vector2Dot(Vector2Subtract(c->position, P->vertex(axis)), P->normals[axis]) > c->radius) {
+        cacheHit = true;
+        return false;
+    }
 
-            FizziksShape sA = A->Shape();
-            FizziksShape sB = B->Shape();
+    // Edge the centre is farthest in front of
+    int e = 0;
+    float sep = -INFINITY;
+    for (int i = 0; i < n; ++i) {
+        float d = Vector2Dot(Vector2Subtract(c->position, P->vertex(i)), P->normals[i]);
+        if (d > sep) { sep = d; e = i; }
+        if (d > c->radius) break;
+    }
+    axis = e;
+    if (sep > c->radius) return false;
 
-            bool overlap = false;
+    Vector2 v1 = P->vertex(e);
+    Vector2 v2 = P->vertex(e + 1 < n ? e + 1 : 0);
+    m.count = 1;
+    if (sep > 0.0f) {
+        // Centre outside: closest feature is the edge or one of its ends
+        Vector2 corner{ 0, 0 };
+        bool atCorner = true;
+        if (Vector2Dot(Vector2Subtract(c->position, v1), Vector2Subtract(v2, v1)) <= 0.0f) corner = v1;
+        else if (Vector2Dot(Vector2Subtract(c->position, v2), Vector2Subtract(v1, v2)) <= 0.0f) corner = v2;
+        else atCorner = false;
 
-            if (sA == CIRCLE && sB == CIRCLE) {
-                auto* a = (FizziksCircle*)A, * b = (FizziksCircle*)B;
-                overlap = CircleCircleOverlap(a, b);
-                if (overlap) {
-                    A->color = RED; B->color = RED;
-                    SeparateCircleCircle(a, b);
-                }
-            }
-            else if (sA == CIRCLE && sB == HALF_SPACE) {
-                auto* c = (FizziksCircle*)A; auto* h = (FizziksHalfspace*)B;
-                overlap = CircleHalfspaceOverlap(c, h);
-                if (overlap) {
-                    A->color = RED; B->color = RED;
-                    SeparateCircleHalfspace(c, h);
-                }
-            }
-            else if (sA == HALF_SPACE && sB == CIRCLE) {
-                auto* h = (FizziksHalfspace*)A; auto* c = (FizziksCircle*)B;
-                overlap = CircleHalfspaceOverlap(c, h);
-                if (overlap) {
-                    A->color = RED; B->color = RED;
-                    SeparateCircleHalfspace(c, h);
-                }
-            }
+        if (atCorner) {
+            Vector2 d = Vector2Subtract(c->position, corner);
+            float dist = Vector2Length(d);
+            if (dist > c->radius) return false;
+            m.normal = dist > 0.0f ? Vector2Scale(d, 1.0f / dist) : P->normals[e];
+            m.penetration = c->radius - dist;
+            m.points[0] = corner;
+            return true;
         }
     }
+    m.normal = P->normals[e];
+    m.penetration = c->radius - sep;
+    m.points[0] = Vector2Subtract(c->position, Vector2Scale(m.normal, sep));
+    return true;
 }
 
-void FizziksWorld::cleanupOffscreen()
+// Up to the two deepest vertices behind the plane; normal from the polygon
+// into the plane
+static bool CollidePolygonHalfspace(const FizziksPolygon* P, const FizziksHalfspace* h, FizziksManifold& m)
 {
-    for (int i = 0; i < (int)objekts.size(); ++i) {
-        FizziksObjekt* o = objekts[i];
-        if (o->Shape() == HALF_SPACE) continue;
-
-        bool off =
-            (o->position.y > GetScreenHeight() + 300) || (o->position.y < -300) ||
-            (o->position.x > GetScreenWidth() + 300) || (o->position.x < -300);
-
-        if (off) {
-            delete o;
-            objekts.erase(objekts.begin() + i);
-            --i;
+    Vector2 n = h->getNormal();
+    float depth[2] = { 0.0f, 0.0f };
+    m.count = 0;
+    for (int i = 0; i < P->count(); ++i) {
+        Vector2 v = P->vertex(i);
+        float d = Vector2Dot(Vector2Subtract(v, h->position), n);
+        if (d >= 0.0f) continue;
+        if (m.count < 2) { m.points[m.count] = v; depth[m.count++] = d; }
+        else {
+            int shallow = depth[0] > depth[1] ? 0 : 1;
+            if (d < depth[shallow]) { m.points[shallow] = v; depth[shallow] = d; }
         }
     }
+    if (m.count == 0) return false;
+    m.normal = Vector2Negate(n);
+    m.penetration = -fminf(depth[0], m.count > 1 ? depth[1] : depth[0]);
+    return true;
 }
 
-//   Setup 4 spheres
-
-static void SpawnFrictionSpheres()
+// Pushes A and B apart along n (A -> B), like SeparateCircleCircle
+static void SeparateBodies(FizziksObjekt* a, FizziksObjekt* b, Vector2 n, float pen)
 {
-    float yStart = 200.0f;
-    float xStart = 350.0f;
-    float spacing = 100.0f;
+    float moveA = a->isStatic ? 0.0f : 1.0f;
+    float moveB = b->isStatic ? 0.0f : 1.0f;
+    float sum = moveA + moveB;
+    if (sum <= 0.0f) return;
 
-    // Red    – 2 kg, μ = 0.1
-    {
-        auto* c = new FizziksCircle();
-        c->position = { xStart + 0 * spacing, yStart };
-        c->velocity = { 0, 0 };
-        c->radius = 18.0f;
-        c->mass = 2.0f;
-        c->kFriction = 0.1f;
-        c->baseColor = RED;  c->color = RED;
-        world.add(c);
-    }
-    // Green  – 2 kg, μ = 0.8
-    {
-        auto* c = new FizziksCircle();
-        c->position = { xStart + 1 * spacing, yStart };
-        c->velocity = { 0, 0 };
-        c->radius = 18.0f;
-        c->mass = 2.0f;
-        c->kFriction = 0.8f;
-        c->baseColor = GREEN;  c->color = GREEN;
-        world.add(c);
-    }
-    // Blue   – 8 kg, μ = 0.1
-    {
-        auto* c = new FizziksCircle();
-        c->position = { xStart + 2 * spacing, yStart };
-        c->velocity = { 0, 0 };
-        c->radius = 18.0f;
-        c->mass = 8.0f;
-        c->kFriction = 0.1f;
-        c->baseColor = BLUE;  c->color = BLUE;
-        world.add(c);
-    }
-    // Yellow – 8 kg, μ = 0.8
-    {
-        auto* c = new FizziksCircle();
-        c->position = { xStart + 3 * spacing, yStart };
-        c->velocity = { 0, 0 };
-        c->radius = 18.0f;
-        c->mass = 8.0f;
-        c->kFriction = 0.8f;
-        c->baseColor = YELLOW;  c->color = YELLOW;
-        world.add(c);
-    }
+    Vector2 corr = Vector2Scale(n, pen + EPS);
+    a->position = Vector2Subtract(a->position, Vector2Scale(corr, moveA / sum));
+    b->position = Vector2Add(b->position, Vector2Scale(corr, moveB / sum));
+
+    float vAn = Vector2Dot(a->velocity, n);
+    float vBn = Vector2Dot(b->velocity, n);
+    if (!a->isStatic && vAn > 0) a->velocity = Vector2Subtract(a->velocity, Vector2Scale(n, vAn));
+    if (!b->isStatic && vBn < 0) b->velocity = Vector2Subtract(b->velocity, Vector2Scale(n, vBn));
 }
 
-//   Per-frame draw
+// Per step counters of the polygon pair tests
+struct FizziksSatStats {
+    int pairs = 0;              // polygon pairs that passed the AABB test
+    int cacheRejects = 0;       // settled by last step's axis alone
+    int contacts = 0;
+};
 
-static void drawFrame()
+// Z-order (Morton) code of p inside area: 16 bits per axis, interleaved, so
+// bodies sorted by it are close in memory when they are close in space
+static inline unsigned int MortonSpread(unsigned int v)
 {
-    BeginDrawing();
-    ClearBackground(BLACK);
+    v &= 0xFFFF;
+    v = (v | (v << 8)) & 0x00FF00FF;
+    v = (v | (v << 4)) & 0x0F0F0F0F;
+    v = (v | (v << 2)) & 0x33333333;
+    v = (v | (v << 1)) & 0x55555555;
+    return v;
+}
 
-    // Header/footer
-    DrawText("Aathiththan Yogeswaran 101462564", 10, GetScreenHeight() - 26, 20, LIGHTGRAY);
-    DrawText(TextFormat("Objects: %i", (int)world.objekts.size()), 10, 10, 20, LIGHTGRAY);
+static inline unsigned int MortonCode(Vector2 p, Rectangle area)
+{
+    float u = (p.x - area.x) / area.width, v = (p.y - area.y) / area.height;
+    unsigned int x = (unsigned int)(fminf(fmaxf(u, 0.0f), 1.0f) * 65535.0f);
+    unsigned int y = (unsigned int)(fminf(fmaxf(v, 0.0f), 1.0f) * 65535.0f);
+    return MortonSpread(x) | (MortonSpread(y) << 1);
+}
 
-    // GUI – sliders (same look as previous labs)
-    GuiSliderBar(Rectangle{ 10, 40, 500, 26 }, "Ground angle",
-        TextFormat("%.1f deg", groundAngleDeg), &groundAngleDeg, -45.0f, 45.0f);
+// Body order counters (FizziksWorld::reorderBodies). The pair distance is
+// how far apart in objekts the two bodies of a broadphase pair sit, on
+// average: a stand-in for the cache misses of the collision pass.
+struct FizziksLocalityStats {
+    double pairDistance = 0.0;      // last step
+    double baseline = 0.0;          // first step, then the first step after each sort; 0 = next step
+    long long sorts = 0;
+    double sortSeconds = 0.0;       // the last one
+};
 
-    GuiSliderBar(Rectangle{ 10, 72, 500, 26 }, "GravityY",
-        TextFormat("%.0f", world.accelerationGravity.y),
-        &world.accelerationGravity.y, 0.0f, 1000.0f);
+// Verlet neighbour list counters (FizziksWorld::useNeighbourList)
+struct FizziksNeighbourStats {
+    long long steps = 0;        // collision passes that used the list
+    long long rebuilds = 0;
+    int pairs = 0;              // in the current list
+    float rebuildRate() const { return steps ? (float)rebuilds / steps : 0.0f; }
+};
 
-    // Color legend
-    DrawText("Vectors: RED = velocity, PURPLE = gravity, GREEN = normal, ORANGE = friction",
-        10, 110, 18, LIGHTGRAY);
+//   Broadphase: hierarchical grid
+// Uniform grids in levels, each with cells twice the size of the previous
+// one's. A body goes into the finest level whose cells are at least as big
+// as its AABB, so it touches at most 2x2 cells there, and 2 px particles
+// never share cells with 300 px boulders. All levels are rebuilt together
+// with one counting sort into two flat arrays (per-cell start offsets +
+// objekt indices) that are reused every step; levels without bodies get no
+// cells. Halfspaces are infinite and terrain has its own BVH; both are kept
+// out of the grid.
 
-    world.draw();
+struct FizziksGrid {
+    static const int MaxLevels = 12;
 
-    EndDrawing();
-}
+    struct Level {
+        float   cellSize = 0.0f;
+        Vector2 origin{ 0, 0 };
+        int     cols = 0;
+        int     rows = 0;
+        int     firstCell = 0;              // its cells start here in cellStart
+        // Union of its AABBs. Bodies poking out of the area are clamped into
+        // the edge cells, so those cells really extend to this rectangle.
+        Vector2 contentMin{ 0, 0 };
+        Vector2 contentMax{ 0, 0 };
 
-//       Entry
-int main()
-{
-    InitWindow(InitialWidth, InitialHeight, "GAME2005 – Lab 6: Kinetic Friction on Halfspace");
-    SetTargetFPS(TARGET_FPS);
+        int cellX(float x) const {
+            int c = (int)floorf((x - origin.x) / cellSize);
+            return c < 0 ? 0 : (c >= cols ? cols - 1 : c);
+        }
+        int cellY(float y) const {
+            int c = (int)floorf((y - origin.y) / cellSize);
+            return c < 0 ? 0 : (c >= rows ? rows - 1 : c);
+        }
+        int cell(int x, int y) const { return firstCell + y * cols + x; }
+    };
 
-    // --- Single adjustable Halfspace (ground) ---
-    {
-        auto* g0 = new FizziksHalfspace();
-        g0->position = { 640, 540 };   // roughly center-bottom
-        g0->setRotationDegrees(groundAngleDeg);
-        g0->baseColor = GRAY;
-        g0->color = GRAY;
-        g0->makeStatic(true);
-        world.add(g0);
-        gGround = g0;                   // store pointer for forces
+    float   cellSize = 32.0f;                   // level 0
+    Level   levels[MaxLevels];
+    int     levelCount = 0;                     // coarsest level in use + 1
+    unsigned int occupied = 0;                  // bit per level holding bodies
+    FizziksVector<int, MEM_BROADPHASE> cellStart;     // all cells + 1 offsets into items
+    FizziksVector<int, MEM_BROADPHASE> items;         // objekt indices grouped by cell
+    FizziksVector<unsigned int, MEM_BROADPHASE> itemCategory;     // per item, copied so the pair
+    FizziksVector<unsigned int, MEM_BROADPHASE> itemMask;         // filter never touches the objekt
+    FizziksVector<signed char, MEM_BROADPHASE> objektLevel;       // per objekt, -1 = not in the grid
+    unsigned int categories = 0;                // union over inserted bodies
+
+    bool inUse(int level) const { return (occupied >> level) & 1; }
+
+    // margin grows every AABB (neighbour lists build on a skin)
+    void build(const FizziksObjektList& objekts, Rectangle area, float margin = 0.0f) {
+        // Pass 1: level of each body, and what each level holds
+        int n = (int)objekts.size();
+        objektLevel.resize(n);
+        occupied = 0;
+        for (Level& lv : levels) {
+            lv.contentMin = Vector2{ INFINITY, INFINITY };
+            lv.contentMax = Vector2{ -INFINITY, -INFINITY };
+        }
+        for (int i = 0; i < n; ++i) {
+            FizziksObjekt* o = objekts[i];
+            if (o->Shape() == HALF_SPACE || o->Shape() == TERRAIN) { objektLevel[i] = -1; continue; }
+            Vector2 lo = Vector2SubtractValue(o->boundsMin, margin);
+            Vector2 hi = Vector2AddValue(o->boundsMax, margin);
+            float extent = fmaxf(hi.x - lo.x, hi.y - lo.y);
+            int level = 0;
+            while (level < MaxLevels - 1 && cellSize * (float)(1 << level) < extent) ++level;
+            objektLevel[i] = (signed char)level;
+            occupied |= 1u << level;
+            levels[level].contentMin = Vector2Min(levels[level].contentMin, lo);
+            levels[level].contentMax = Vector2Max(levels[level].contentMax, hi);
+        }
+
+        int cellCount = 0;
+        levelCount = 0;
+        for (int level = 0; level < MaxLevels; ++level) {
+            Level& lv = levels[level];
+            lv.cellSize = cellSize * (float)(1 << level);
+            lv.origin = Vector2{ area.x, area.y };
+            lv.cols = lv.rows = 0;
+            lv.firstCell = cellCount;
+            if (!inUse(level)) continue;
+            lv.cols = std::max(1, (int)ceilf(area.width / lv.cellSize));
+            lv.rows = std::max(1, (int)ceilf(area.height / lv.cellSize));
+            cellCount += lv.cols * lv.rows;
+            levelCount = level + 1;
+        }
+        cellStart.assign(cellCount + 1, 0);
+
+        // Pass 2: count entries per cell
+        for (int i = 0; i < n; ++i) {
+            if (objektLevel[i] < 0) continue;
+            FizziksObjekt* o = objekts[i];
+            const Level& lv = levels[objektLevel[i]];
+            int x0 = lv.cellX(o->boundsMin.x - margin), x1 = lv.cellX(o->boundsMax.x + margin);
+            int y0 = lv.cellY(o->boundsMin.y - margin), y1 = lv.cellY(o->boundsMax.y + margin);
+            for (int y = y0; y <= y1; ++y)
+                for (int x = x0; x <= x1; ++x)
+                    ++cellStart[lv.cell(x, y) + 1];
+        }
+        for (int c = 0; c < cellCount; ++c) cellStart[c + 1] += cellStart[c];
+
+        // Pass 3: scatter indices (+ layer bits)
+        int itemCount = cellStart[cellCount];
+        items.resize(itemCount);
+        itemCategory.resize(itemCount);
+        itemMask.resize(itemCount);
+        categories = 0;
+        cursor.assign(cellStart.begin(), cellStart.end() - 1);
+        for (int i = 0; i < n; ++i) {
+            if (objektLevel[i] < 0) continue;
+            FizziksObjekt* o = objekts[i];
+            const Level& lv = levels[objektLevel[i]];
+            categories |= o->category;
+            int x0 = lv.cellX(o->boundsMin.x - margin), x1 = lv.cellX(o->boundsMax.x + margin);
+            int y0 = lv.cellY(o->boundsMin.y - margin), y1 = lv.cellY(o->boundsMax.y + margin);
+            for (int y = y0; y <= y1; ++y) {
+                for (int x = x0; x <= x1; ++x) {
+                    int k = cursor[lv.cell(x, y)]++;
+                    items[k] = i;
+                    itemCategory[k] = o->category;
+                    itemMask[k] = o->mask;
+                }
+            }
+        }
     }
 
-    // 4 spheres with different mass/μ
-    SpawnFrictionSpheres();
+private:
+    FizziksVector<int, MEM_BROADPHASE> cursor;        // build scratch
+};
+
+//   Integrators (FizziksWorld::integrator)
+enum FizziksIntegrator
+{
+    INTEGRATOR_EULER,                   // explicit: position, then velocity
+    INTEGRATOR_SEMI_IMPLICIT_EULER,     // velocity, then position
+    INTEGRATOR_VELOCITY_VERLET,
+    INTEGRATOR_RK4,
+    INTEGRATOR_COUNT
+};
 
-    while (!WindowShouldClose()) {
-        // Update ground rotation each frame from slider
-        if (gGround) gGround->setRotationDegrees(groundAngleDeg);
+// Energy / momentum drift since the baseline (see FizziksWorld::sampleDrift)
+struct FizziksDriftStats {
+    int     bodies = -1;
+    FizziksIntegrator integrator = INTEGRATOR_COUNT;
+    Vector2 gravity{ 0, 0 };
+    int     steps = 0;
+    double  energy0 = 0.0;
+    double  momentum0x = 0.0, momentum0y = 0.0;
+    double  energy = 0.0;
+    double  energyDrift = 0.0;      // relative to |energy0|
+    double  momentumDrift = 0.0;    // |P - P0| / total mass (px/s)
+};
+
+//   Spatial query results
+struct FizziksRayHit {
+    FizziksObjekt* objekt = nullptr;
+    float   distance = 0.0f;        // along the normalized ray direction
+    Vector2 point{ 0, 0 };
+    Vector2 normal{ 0, 0 };
+};
+
+// Key of an unordered body pair: (low id << 32) | high id
+static inline unsigned long long PairKey(unsigned int a, unsigned int b)
+{
+    return a < b ? ((unsigned long long)a << 32) | b : ((unsigned long long)b << 32) | a;
+}
+
+// Layer filter: both bodies must accept each other's category
+static inline bool LayersCollide(const FizziksObjekt* A, const FizziksObjekt* B)
+{
+    return (A->category & B->mask) && (B->category & A->mask);
+}
+
+//   Trigger / contact events
+// Pairs are keyed by the two body ids, so events stay valid after bodies are
+// deleted. a < b always.
+enum FizziksTriggerEventType
+{
+    TRIGGER_ENTER,
+    TRIGGER_STAY,
+    TRIGGER_EXIT
+};
+
+struct FizziksTriggerEvent {
+    FizziksTriggerEventType type;
+    unsigned int a;
+    unsigned int b;
+};
+
+//   Command queue
+// Changes to the world from outside the step (UI, input, script threads)
+// are queued as commands and applied by FizziksWorld::applyCommands() at the
+// start of the next step, so nothing writes world state while a step runs.
+// The queue is a bounded lock-free ring (Vyukov's MPMC queue): every slot
+// carries a sequence number saying whether it is free for the producer of
+// this lap or filled for its consumer. Slots are allocated up front; push()
+// never blocks and returns false when the ring is full.
+
+enum FizziksCommandType
+{
+    CMD_ADD,            // objekt: ownership passes to the world
+    CMD_REMOVE,         // id; static bodies stay, like in cleanup
+    CMD_SET_GRAVITY,    // vector
+    CMD_SET_ROTATION,   // id, scalar = degrees (halfspaces)
+    CMD_SET_INTEGRATOR  // mode
+};
+
+struct FizziksCommand {
+    FizziksCommandType type = CMD_ADD;
+    FizziksObjekt* objekt = nullptr;
+    unsigned int id = 0;
+    Vector2 vector{ 0, 0 };
+    float scalar = 0.0f;
+    int   mode = 0;
+
+    static FizziksCommand Add(FizziksObjekt* o) { FizziksCommand c; c.type = CMD_ADD; c.objekt = o; return c; }
+    static FizziksCommand Remove(unsigned int id) { FizziksCommand c; c.type = CMD_REMOVE; c.id = id; return c; }
+    static FizziksCommand SetGravity(Vector2 g) { FizziksCommand c; c.type = CMD_SET_GRAVITY; c.vector = g; return c; }
+    static FizziksCommand SetRotation(unsigned int id, float degrees) {
+        FizziksCommand c; c.type = CMD_SET_ROTATION; c.id = id; c.scalar = degrees; return c;
+    }
+    static FizziksCommand SetIntegrator(FizziksIntegrator i) { FizziksCommand c; c.type = CMD_SET_INTEGRATOR; c.mode = i; return c; }
+};
+
+struct FizziksCommandQueue {
+    // capacity is rounded up to a power of two
+    explicit FizziksCommandQueue(size_t capacity) {
+        size_t n = 2;
+        while (n < capacity) n <<= 1;
+        slots.reset(new Slot[n]);
+        mask = n - 1;
+        for (size_t i = 0; i < n; ++i) slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+    // False when full; the caller still owns c.objekt then
+    bool push(const FizziksCommand& c) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots[pos & mask];
+            size_t seq = slot->sequence.load(std::memory_order_acquire);
+            long long diff = (long long)seq - (long long)pos;
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if (diff < 0) return false;
+            else pos = tail.load(std::memory_order_relaxed);
+        }
+        slot->command = c;
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(FizziksCommand& out) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots[pos & mask];
+            size_t seq = slot->sequence.load(std::memory_order_acquire);
+            long long diff = (long long)seq - (long long)(pos + 1);
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if (diff < 0) return false;
+            else pos = head.load(std::memory_order_relaxed);
+        }
+        out = slot->command;
+        slot->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence{ 0 };
+        FizziksCommand command;
+    };
+    std::unique_ptr<Slot[]> slots;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> head{ 0 };     // apart, so producers and
+    alignas(64) std::atomic<size_t> tail{ 0 };     // the consumer don't share a line
+};
+
+//   Time scrubbing: checkpoints
+// Every checkpointInterval steps the world keeps a snapshot of the moving
+// state only: position + velocity per body (20 bytes). The rest of a body
+// lives once in a shared descriptor table, referenced by index; a new
+// descriptor is added only when a body is first seen or one of its
+// properties changed. When the snapshots outgrow checkpointBudget every
+// second one is dropped and the interval doubles, so the whole session stays
+// covered at a coarser spacing.
+
+struct FizziksBodyDesc {
+    unsigned int id;
+    FizziksShape shape;
+    bool  isStatic, isSensor, reportContacts, hasExclusions;
+    unsigned int category, mask;
+    float mass;
+    float radius, kFriction;        // circles
+    float rotationDeg;              // halfspaces
+    int   vertexStart, vertexCount; // polygons, in the world's descVertices
+    Color baseColor;
+};
+
+struct FizziksBodyState {
+    unsigned int desc;              // index into the descriptor table
+    Vector2 position;
+    Vector2 velocity;
+};
+
+struct FizziksCheckpoint {
+    long long step = 0;
+    float     time = 0.0f;
+    Vector2   gravity{ 0, 0 };
+    FizziksIntegrator integrator = INTEGRATOR_SEMI_IMPLICIT_EULER;
+    FizziksVector<FizziksBodyState, MEM_HISTORY> bodies;       // in objekts order
+    FizziksVector<unsigned long long, MEM_HISTORY> pairs;      // lastPairs, so events carry on
+    double    localityBaseline = 0.0;                           // so replays sort bodies at the same steps
+
+    size_t bytes() const {
+        return bodies.capacity() * sizeof(FizziksBodyState) + pairs.capacity() * sizeof(unsigned long long);
+    }
+};
+
+// Every command applied to the world is logged with the step it went in at,
+// so re-simulating from a checkpoint applies the same input at the same
+// steps. An added body is kept as a descriptor plus its start state.
+struct FizziksLoggedCommand {
+    long long step;
+    FizziksCommand command;         // CMD_ADD: id only, the body is in state
+    FizziksBodyState state;
+};
+
+//   Instanced circle renderer (SDF)
+// All circles go into one instance buffer (centre, radius, colour) and are
+// drawn as a single instanced quad; the fragment shader cuts the circle out
+// with a signed distance, so there is no per-circle tessellation on the CPU.
+// Needs GL 3.3+; on GL 2.1 / ES2 ready stays false and the world keeps using
+// DrawCircleV.
+
+static const char* CIRCLE_VS = R"(#version 330
+layout(location = 0) in vec2 vertexCorner;     // quad corner in [-1, 1]
+layout(location = 1) in vec3 instanceCircle;   // centre.xy, radius
+layout(location = 2) in vec4 instanceColor;
+uniform mat4 mvp;
+uniform float pixelSize;                        // world units per screen pixel
+out vec2 fragLocal;
+out float fragRadius;
+out vec4 fragColor;
+void main()
+{
+    float r = instanceCircle.z + pixelSize;     // 1 px pad for the AA edge
+    fragLocal = vertexCorner * r;
+    fragRadius = instanceCircle.z;
+    fragColor = instanceColor;
+    gl_Position = mvp * vec4(instanceCircle.xy + fragLocal, 0.0, 1.0);
+}
+)";
+
+static const char* CIRCLE_FS = R"(#version 330
+in vec2 fragLocal;
+in float fragRadius;
+in vec4 fragColor;
+out vec4 finalColor;
+void main()
+{
+    float d = length(fragLocal) - fragRadius;   // signed distance (px)
+    float aa = fwidth(d);
+    float alpha = 1.0 - smoothstep(-aa, aa, d);
+    if (alpha <= 0.0) discard;
+    finalColor = vec4(fragColor.rgb, fragColor.a * alpha);
+}
+)";
+
+struct FizziksCircleRenderer {
+    struct Instance {
+        Vector2 center;
+        float   radius;
+        Color   color;
+    };
+
+    bool ready = false;
+    FizziksVector<Instance, MEM_RENDER> instances;
+
+    bool init() {
+        int gl = rlGetVersion();
+        if (gl != RL_OPENGL_33 && gl != RL_OPENGL_43) return false;   // GL 2.1 fallback
+
+        shader = LoadShaderFromMemory(CIRCLE_VS, CIRCLE_FS);
+        if (!IsShaderValid(shader) || shader.id == rlGetShaderIdDefault()) return false;
+        mvpLoc = GetShaderLocation(shader, "mvp");
+        pixelSizeLoc = GetShaderLocation(shader, "pixelSize");
+
+        // Two triangles covering [-1,1]^2
+        static const float corners[12] = {
+            -1, -1,   1, -1,   1,  1,
+            -1, -1,   1,  1,  -1,  1
+        };
+
+        vao = rlLoadVertexArray();
+        rlEnableVertexArray(vao);
+        quadVbo = rlLoadVertexBuffer(corners, sizeof(corners), false);
+        rlSetVertexAttribute(0, 2, RL_FLOAT, false, 0, 0);
+        rlEnableVertexAttribute(0);
+        allocInstanceBuffer(1024);
+        rlDisableVertexArray();
+
+        ready = true;
+        return true;
+    }
+
+    void unload() {
+        if (!ready) return;
+        rlUnloadVertexBuffer(instanceVbo);
+        rlUnloadVertexBuffer(quadVbo);
+        rlUnloadVertexArray(vao);
+        UnloadShader(shader);
+        ready = false;
+    }
+
+    void push(Vector2 center, float radius, Color color) {
+        instances.push_back(Instance{ center, radius, color });
+    }
+
+    // n slots to fill directly, e.g. from jobs
+    Instance* append(int n) {
+        size_t base = instances.size();
+        instances.resize(base + n);
+        return instances.data() + base;
+    }
+
+    // Upload this frame's instances and draw them in one call
+    void flush(float pixelSize = 1.0f) {
+        int n = (int)instances.size();
+        if (n == 0) return;
+
+        // Anything raylib has batched so far must land underneath the circles
+        rlDrawRenderBatchActive();
+
+        rlEnableVertexArray(vao);
+        if (n > capacity) {
+            int cap = capacity;
+            while (cap < n) cap *= 2;
+            rlUnloadVertexBuffer(instanceVbo);
+            allocInstanceBuffer(cap);
+        }
+        rlUpdateVertexBuffer(instanceVbo, instances.data(), n * (int)sizeof(Instance), 0);
+
+        rlEnableShader(shader.id);
+        rlSetUniformMatrix(mvpLoc, MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+        rlSetUniform(pixelSizeLoc, &pixelSize, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlDrawVertexArrayInstanced(0, 6, n);
+        rlDisableShader();
+        rlDisableVertexArray();
+
+        instances.clear();
+    }
+
+private:
+    Shader shader{};
+    int mvpLoc = -1;
+    int pixelSizeLoc = -1;
+    unsigned int vao = 0;
+    unsigned int quadVbo = 0;
+    unsigned int instanceVbo = 0;
+    int capacity = 0;
+
+    // Expects the VAO to be bound
+    void allocInstanceBuffer(int cap) {
+        capacity = cap;
+        instanceVbo = rlLoadVertexBuffer(nullptr, cap * (int)sizeof(Instance), true);
+        rlSetVertexAttribute(1, 3, RL_FLOAT, false, sizeof(Instance), offsetof(Instance, center));
+        rlEnableVertexAttribute(1);
+        rlSetVertexAttributeDivisor(1, 1);
+        rlSetVertexAttribute(2, 4, RL_UNSIGNED_BYTE, true, sizeof(Instance), offsetof(Instance, color));
+        rlEnableVertexAttribute(2);
+        rlSetVertexAttributeDivisor(2, 1);
+    }
+};
+
+static FizziksCircleRenderer gCircleRenderer;
+
+//   Body label renderer
+// Each numeric id is baked once into a run of glyph quads (offsets + atlas
+// UVs of the default font), so drawing a label is just copying its quads.
+// Labels are culled against the view and by on-screen size, capped per
+// frame, and all emitted in a single textured batch. Runs live in slots
+// pooled by id; a label not drawn this frame gives its slot back.
+
+struct FizziksLabelRenderer {
+    int   fontSize = 12;            // same size the per-body DrawText used
+    float minScreenSize = 8.0f;     // skip labels smaller than this on screen
+    int   maxLabels = 512;          // per-frame cap
+    Color tint = LIGHTGRAY;
+
+    int drawnLastFrame = 0;
+
+    void begin(Rectangle viewRect, float viewZoom) {
+        view = viewRect;
+        zoom = viewZoom;
+        visible.clear();
+        ++frame;
+    }
+
+    // Queue the label of body id with its top-left corner at pos
+    void push(unsigned int id, Vector2 pos) {
+        if ((int)visible.size() >= maxLabels) return;
+        if (fontSize * zoom < minScreenSize) return;
+
+        int slot = bake(id);
+        const LabelRun& run = runs[slot];
+        if (pos.x + run.width < view.x || pos.x > view.x + view.width ||
+            pos.y + fontSize < view.y || pos.y > view.y + view.height) return;
+
+        visible.push_back(Label{ slot, pos });
+    }
+
+    void flush() {
+        drawnLastFrame = (int)visible.size();
+
+        // Labels not pushed this frame (culled, or the body is gone)
+        for (int s = 0; s < (int)runs.size(); ++s) {
+            LabelRun& run = runs[s];
+            if (run.count == 0 || run.lastUsed == frame) continue;
+            slotOfId[run.id] = -1;
+            run.count = 0;
+            freeSlots.push_back(s);
+        }
+        if (visible.empty()) return;
+
+        Font font = GetFontDefault();
+        rlSetTexture(font.texture.id);
+        rlBegin(RL_QUADS);
+        rlColor4ub(tint.r, tint.g, tint.b, tint.a);
+        rlNormal3f(0.0f, 0.0f, 1.0f);
+
+        for (const Label& l : visible) {
+            const LabelRun& run = runs[l.slot];
+            rlCheckRenderBatchLimit(4 * run.count);
+            for (int i = l.slot * MAX_DIGITS; i < l.slot * MAX_DIGITS + run.count; ++i) {
+                const GlyphQuad& q = quads[i];
+                float x0 = l.pos.x + q.x0, y0 = l.pos.y + q.y0;
+                float x1 = l.pos.x + q.x1, y1 = l.pos.y + q.y1;
+                rlTexCoord2f(q.u0, q.v0); rlVertex2f(x0, y0);
+                rlTexCoord2f(q.u0, q.v1); rlVertex2f(x0, y1);
+                rlTexCoord2f(q.u1, q.v1); rlVertex2f(x1, y1);
+                rlTexCoord2f(q.u1, q.v0); rlVertex2f(x1, y0);
+            }
+        }
+
+        rlEnd();
+        rlSetTexture(0);
+    }
+
+private:
+    struct GlyphQuad {
+        float x0, y0, x1, y1;   // offset from label origin (px)
+        float u0, v0, u1, v1;   // font atlas UVs
+    };
+    struct LabelRun {
+        unsigned int id = 0;
+        unsigned int lastUsed = 0;
+        int   count = 0;        // 0 = slot unused
+        float width = 0.0f;
+    };
+    struct Label {
+        int slot;
+        Vector2 pos;
+    };
+    static constexpr int MAX_DIGITS = 10;               // of an unsigned int
+
+    FizziksVector<GlyphQuad, MEM_RENDER> quads;       // MAX_DIGITS per slot
+    FizziksVector<LabelRun, MEM_RENDER>  runs;
+    FizziksVector<int, MEM_RENDER>       slotOfId;
+    FizziksVector<int, MEM_RENDER>       freeSlots;
+    FizziksVector<Label, MEM_RENDER>     visible;
+    Rectangle view{ 0, 0, 0, 0 };
+    float zoom = 1.0f;
+    unsigned int frame = 0;
+
+    // Slot of id, baked on first use in the same layout DrawText/DrawTextEx
+    // produce for the default font
+    int bake(unsigned int id) {
+        if (id >= slotOfId.size()) slotOfId.resize(id + 1, -1);
+        int s = slotOfId[id];
+        if (s >= 0) { runs[s].lastUsed = frame; return s; }
+        if (!freeSlots.empty()) { s = freeSlots.back(); freeSlots.pop_back(); }
+        else {
+            s = (int)runs.size();
+            runs.emplace_back();
+            quads.resize(quads.size() + MAX_DIGITS);
+        }
+        slotOfId[id] = s;
+        LabelRun& run = runs[s];
+        run.id = id;
+        run.lastUsed = frame;
+
+        Font font = GetFontDefault();
+        float scale = (float)fontSize / font.baseSize;
+        float spacing = (float)(fontSize / 10);
+        float pad = (float)font.glyphPadding;
+        float texW = (float)font.texture.width, texH = (float)font.texture.height;
+
+        char text[16];
+        int len = snprintf(text, sizeof(text), "%u", id);
+
+        float x = 0.0f;
+        for (int i = 0; i < len; ++i) {
+            int g = GetGlyphIndex(font, text[i]);
+            Rectangle rec = font.recs[g];
+
+            GlyphQuad q;
+            q.x0 = x + font.glyphs[g].offsetX * scale - pad * scale;
+            q.y0 = font.glyphs[g].offsetY * scale - pad * scale;
+            q.x1 = q.x0 + (rec.width + 2.0f * pad) * scale;
+            q.y1 = q.y0 + (rec.height + 2.0f * pad) * scale;
+            q.u0 = (rec.x - pad) / texW;
+            q.v0 = (rec.y - pad) / texH;
+            q.u1 = (rec.x + rec.width + pad) / texW;
+            q.v1 = (rec.y + rec.height + pad) / texH;
+            quads[(size_t)s * MAX_DIGITS + i] = q;
+
+            float adv = font.glyphs[g].advanceX ? (float)font.glyphs[g].advanceX : rec.width;
+            x += adv * scale + spacing;
+        }
+        run.count = len;
+        run.width = x;
+        return s;
+    }
+};
+
+static FizziksLabelRenderer gLabelRenderer;
+
+//   Debug vector layer
+// Velocity / force arrows from all bodies are collected into one triangle
+// stream (two triangles per thick line) and submitted in a single batch.
+// Each category can be switched off, and vectors shorter than minLength
+// pixels are skipped before any geometry is built.
+
+enum FizziksDebugVector
+{
+    DEBUG_VELOCITY,
+    DEBUG_GRAVITY,
+    DEBUG_NORMAL,
+    DEBUG_FRICTION,
+    DEBUG_VECTOR_COUNT
+};
+
+struct FizziksDebugDraw {
+    bool  enabled[DEBUG_VECTOR_COUNT] = { true, true, true, true };
+    float scale[DEBUG_VECTOR_COUNT] = { 0.1f, 0.02f, 0.02f, 0.02f };   // world units per unit of the vector
+    Color colors[DEBUG_VECTOR_COUNT] = { RED, PURPLE, GREEN, ORANGE };
+    float thickness = 2.0f;
+    float minLength = 1.0f;     // drawn length below this is skipped (px)
+
+    // Jobs write into separate lists (see setLists); flush draws them in order
+    void setLists(int n) { if ((int)lists.size() < n) lists.resize(n); }
+
+    void push(FizziksDebugVector kind, Vector2 from, Vector2 v, int list = 0) {
+        if (!enabled[kind]) return;
+        FizziksVector<Vertex, MEM_RENDER>& verts = lists[list];
+
+        Vector2 d = Vector2Scale(v, scale[kind]);
+        float len2 = Vector2Dot(d, d);
+        if (len2 < minLength * minLength) return;
+
+        // Half-thickness offset perpendicular to the line
+        float k = 0.5f * thickness / sqrtf(len2);
+        Vector2 off{ -d.y * k, d.x * k };
+        Vector2 to = Vector2Add(from, d);
+        Color c = colors[kind];
+
+        Vector2 a = Vector2Add(from, off), b = Vector2Subtract(from, off);
+        Vector2 e = Vector2Subtract(to, off), f = Vector2Add(to, off);
+        // Same winding as DrawLineEx, so back-face culling keeps both triangles
+        verts.push_back(Vertex{ e, c }); verts.push_back(Vertex{ b, c }); verts.push_back(Vertex{ a, c });
+        verts.push_back(Vertex{ f, c }); verts.push_back(Vertex{ e, c }); verts.push_back(Vertex{ a, c });
+    }
+
+    void flush() {
+        for (FizziksVector<Vertex, MEM_RENDER>& verts : lists) {
+            if (verts.empty()) continue;
+
+            rlCheckRenderBatchLimit((int)verts.size());
+            rlBegin(RL_TRIANGLES);
+            for (const Vertex& v : verts) {
+                rlColor4ub(v.color.r, v.color.g, v.color.b, v.color.a);
+                rlVertex2f(v.pos.x, v.pos.y);
+            }
+            rlEnd();
+
+            verts.clear();
+        }
+    }
+
+private:
+    struct Vertex {
+        Vector2 pos;
+        Color   color;
+    };
+    FizziksVector<FizziksVector<Vertex, MEM_RENDER>, MEM_RENDER> lists =
+        FizziksVector<FizziksVector<Vertex, MEM_RENDER>, MEM_RENDER>(1);
+};
+
+static FizziksDebugDraw gDebugDraw;
+
+//   World (polymorphic)
+
+//   Job system
+// Work-stealing scheduler. Every thread owns a deque: it pushes and pops its
+// own jobs at the back, and when it runs dry it steals from the front of
+// another thread's deque. The deques are std::deques behind a mutex rather
+// than lock-free Chase-Lev deques; jobs here are chunks of thousands of
+// bodies, so the locks are rarely contended. A job decrements its
+// FizziksJobCounter when done; wait() runs jobs of that counter until it
+// reaches zero, so the waiting thread helps instead of blocking, but never
+// picks up another thread's work (the main thread must not end up running
+// the sim thread's step). Phases with dependencies are chained by waiting on
+// one counter before submitting the next. Idle workers sleep on a condition
+// variable until a job is submitted.
+// By default there are hardware threads - 2 workers, leaving a core each for
+// the main thread and raylib's audio thread; with none, jobs run inline.
+
+struct FizziksJobCounter {
+    std::atomic<int> value{ 0 };
+};
+
+struct FizziksJob {
+    void (*fn)(void* data, int begin, int end);
+    void* data;
+    int   begin, end;
+    FizziksJobCounter* counter;
+};
+
+struct FizziksJobSystem {
+    ~FizziksJobSystem() { shutdown(); }
+
+    void init(int workers = -1) {
+        shutdown();
+        if (workers < 0) workers = std::max(0, (int)std::thread::hardware_concurrency() - 2);
+        queues.clear();
+        for (int i = 0; i <= workers + 1; ++i) queues.push_back(std::make_unique<Queue>());
+        running = true;
+        for (int i = 1; i <= workers; ++i) threads.emplace_back([this, i]() { workerLoop(i); });
+    }
+
+    void shutdown() {
+        if (!running) return;
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+            running = false;
+        }
+        wake.notify_all();
+        for (auto& t : threads) t.join();
+        threads.clear();
+    }
+
+    // Including the main thread
+    int threadCount() const { return (int)threads.size() + 1; }
+
+    // Threads that can run jobs, adopted one included; indexes per-thread data
+    int slotCount() const { return std::max(1, (int)queues.size()); }
+    static int currentThread() { return threadIndex; }
+
+    // Gives the calling thread (not main, not a worker) the spare slot, so it
+    // can drive jobs alongside the main thread without sharing its deque
+    void adoptThread() { threadIndex = std::max(0, (int)queues.size() - 1); }
+
+    void submit(const FizziksJob& job) {
+        job.counter->value.fetch_add(1, std::memory_order_relaxed);
+        if (threads.empty()) { run(job); return; }          // no workers
+        Queue& q = *queues[threadIndex];
+        {
+            std::lock_guard<std::mutex> guard(q.lock);
+            q.jobs.push_back(job);
+        }
+        {
+            // Under the sleep lock, so a worker between checking and sleeping
+            // cannot miss it
+            std::lock_guard<std::mutex> guard(sleepLock);
+            queued.fetch_add(1, std::memory_order_release);
+        }
+        wake.notify_one();
+    }
+
+    void wait(FizziksJobCounter& counter) {
+        while (counter.value.load(std::memory_order_acquire) > 0)
+            if (!runOne(&counter)) std::this_thread::yield();
+    }
+
+    // body(begin, end) over [0, count) in chunks of grain; returns when all
+    // chunks are done
+    template <typename F>
+    void parallelFor(int count, int grain, F&& body) {
+        if (count <= 0) return;
+        if (threads.empty() || count <= grain) { body(0, count); return; }
+
+        using Body = std::remove_reference_t<F>;
+        FizziksJobCounter counter;
+        for (int b = 0; b < count; b += grain) {
+            submit(FizziksJob{ [](void* data, int begin, int end) { (*(Body*)data)(begin, end); },
+                (void*)&body, b, std::min(count, b + grain), &counter });
+        }
+        wait(counter);
+    }
+
+private:
+    struct Queue {
+        std::mutex lock;
+        std::deque<FizziksJob> jobs;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;     // [0] main thread, then workers, then the spare
+    std::vector<std::thread> threads;
+    std::atomic<bool> running{ false };
+    std::atomic<int>  queued{ 0 };
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    static inline thread_local int threadIndex = 0;
+
+    static void run(const FizziksJob& job) {
+        job.fn(job.data, job.begin, job.end);
+        job.counter->value.fetch_sub(1, std::memory_order_release);
+    }
+
+    // Own deque from the back, then steal from the others' fronts. With a
+    // counter only its jobs are taken (the nearest one to those ends).
+    bool runOne(const FizziksJobCounter* only = nullptr) {
+        int n = (int)queues.size();
+        FizziksJob job;
+        bool found = false;
+        for (int k = 0; k < n && !found; ++k) {
+            Queue& q = *queues[(threadIndex + k) % n];
+            std::lock_guard<std::mutex> guard(q.lock);
+            if (q.jobs.empty()) continue;
+            if (!only) {
+                if (k == 0) { job = q.jobs.back(); q.jobs.pop_back(); }
+                else { job = q.jobs.front(); q.jobs.pop_front(); }
+                found = true;
+            }
+            else if (k == 0) {
+                auto it = std::find_if(q.jobs.rbegin(), q.jobs.rend(), [only](const FizziksJob& j) { return j.counter == only; });
+                if (it == q.jobs.rend()) continue;
+                job = *it;
+                q.jobs.erase(std::next(it).base());
+                found = true;
+            }
+            else {
+                auto it = std::find_if(q.jobs.begin(), q.jobs.end(), [only](const FizziksJob& j) { return j.counter == only; });
+                if (it == q.jobs.end()) continue;
+                job = *it;
+                q.jobs.erase(it);
+                found = true;
+            }
+            if (found) queued.fetch_sub(1, std::memory_order_relaxed);
+        }
+        if (!found) return false;
+        run(job);
+        return true;
+    }
+
+    void workerLoop(int index) {
+        threadIndex = index;
+        while (running) {
+            if (runOne()) continue;
+            std::unique_lock<std::mutex> lock(sleepLock);
+            wake.wait(lock, [this]() { return queued.load() > 0 || !running; });
+        }
+    }
+};
+
+static FizziksJobSystem gJobs;
+
+//   Simulation thread
+// One persistent thread that runs a function per kick(), so a step can run
+// while the main thread draws. wait() blocks until it is done and tells
+// whether anything ran. It adopts the job system's spare slot, so its jobs
+// and per-thread data stay apart from the main thread's.
+
+struct FizziksSimThread {
+    ~FizziksSimThread() { stop(); }
+
+    void start() {
+        if (thread.joinable()) return;
+        quit = false;
+        thread = std::thread([this]() {
+            gJobs.adoptThread();
+            std::unique_lock<std::mutex> lock(mutex);
+            for (;;) {
+                wake.wait(lock, [this]() { return task != nullptr || quit; });
+                if (quit) return;
+                lock.unlock();
+                task();
+                lock.lock();
+                task = nullptr;
+                done.notify_all();
+            }
+        });
+    }
+
+    void stop() {
+        if (!thread.joinable()) return;
+        wait();
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            quit = true;
+        }
+        wake.notify_all();
+        thread.join();
+    }
+
+    void kick(void (*fn)()) {
+        std::lock_guard<std::mutex> guard(mutex);
+        task = fn;
+        kicked = true;
+        wake.notify_all();
+    }
+
+    bool wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this]() { return task == nullptr; });
+        bool ran = kicked;
+        kicked = false;
+        return ran;
+    }
+
+private:
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    void (*task)() = nullptr;
+    bool kicked = false;
+    bool quit = false;
+};
+
+static FizziksSimThread gSimThread;
+
+//   Frame arena
+// Linear allocator for data that lives within one world call (a snapshot):
+// alloc() bumps an offset and reset() drops everything in O(1).
+// Chunks are kept across resets; a reset that finds more than one merges
+// them into a single chunk of the total size, so once the largest frame has
+// been seen no step touches the heap again. Nothing is destructed, so only
+// trivially copyable data goes in.
+
+struct alignas(64) FizziksArena {
+    void* alloc(size_t bytes, size_t align = alignof(std::max_align_t)) {
+        size_t at = (offset + align - 1) & ~(align - 1);
+        if (chunks.empty() || at + bytes > chunks.back().size) {
+            size_t size = chunks.empty() ? (size_t)64 << 10 : chunks.back().size * 2;
+            addChunk(std::max(size, bytes + align));
+            at = 0;
+        }
+        offset = at + bytes;
+        return chunks.back().data.data() + at;
+    }
+
+    void reset() {
+        size_t used = bytesUsed();
+        if (used > peak) peak = used;
+        if (chunks.size() > 1) {
+            size_t total = capacity();
+            chunks.clear();
+            addChunk(total);
+        }
+        spilled = offset = 0;
+    }
+
+    size_t bytesUsed() const { return spilled + offset; }
+    size_t peakBytes() const { return std::max(peak, bytesUsed()); }
+    size_t capacity() const {
+        size_t n = 0;
+        for (const Chunk& c : chunks) n += c.size;
+        return n;
+    }
+    int heapAllocations() const { return allocations; }
+
+private:
+    struct Chunk {
+        FizziksVector<unsigned char, MEM_SCRATCH> data;
+        size_t size;
+    };
+    std::vector<Chunk> chunks;          // allocating from the last one
+    size_t offset = 0;                  // in the last chunk
+    size_t spilled = 0;                 // used in the earlier ones
+    size_t peak = 0;
+    int allocations = 0;
+
+    void addChunk(size_t size) {
+        spilled += chunks.empty() ? 0 : offset;
+        chunks.push_back(Chunk{ FizziksVector<unsigned char, MEM_SCRATCH>(size), size });
+        offset = 0;
+        ++allocations;
+    }
+};
+
+// One arena per job system slot; jobs allocate from their thread's arena
+// through local(). Reset only between world calls, when no job is running.
+struct FizziksFrameArena {
+    FizziksArena& local() { return arenas[FizziksJobSystem::currentThread()]; }
+
+    void reset() {
+        size_t used = 0;
+        for (auto& a : arenas) {
+            used += a.bytesUsed();
+            a.reset();
+        }
+        if (used > peak) peak = used;
+        if ((int)arenas.size() < gJobs.slotCount()) arenas.resize(gJobs.slotCount());
+    }
+
+    size_t peakBytes() const { return peak; }
+    size_t capacity() const {
+        size_t n = 0;
+        for (const auto& a : arenas) n += a.capacity();
+        return n;
+    }
+    int heapAllocations() const {
+        int n = 0;
+        for (const auto& a : arenas) n += a.heapAllocations();
+        return n;
+    }
+
+private:
+    std::vector<FizziksArena> arenas;
+    size_t peak = 0;                    // all threads, at one reset
+};
+
+// Growable array in an arena. Growing copies into a new block and leaves
+// the old one to the next reset.
+template <typename T>
+struct FizziksScratch {
+    static_assert(std::is_trivially_copyable<T>::value, "arena data is never destructed");
+
+    FizziksScratch() = default;
+    explicit FizziksScratch(FizziksArena& a, size_t reserve = 0) : arena(&a) { if (reserve) grow(reserve); }
+
+    void push_back(const T& v) {
+        if (count == cap) grow(cap ? cap * 2 : 64);
+        items[count++] = v;
+    }
+    void clear() { count = 0; }
+
+    T* begin() { return items; }
+    T* end() { return items + count; }
+    const T* begin() const { return items; }
+    const T* end() const { return items + count; }
+    T& operator[](size_t i) { return items[i]; }
+    const T& operator[](size_t i) const { return items[i]; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+private:
+    FizziksArena* arena = nullptr;
+    T* items = nullptr;
+    size_t count = 0, cap = 0;
+
+    void grow(size_t n) {
+        T* p = (T*)arena->alloc(n * sizeof(T), alignof(T));
+        if (count) memcpy(p, items, count * sizeof(T));
+        items = p;
+        cap = n;
+    }
+};
+
+//   Particle emitter
+// Lightweight circles that never become FizziksObjekts: plain structs in a
+// fixed-capacity ring, spawned into a cone at `rate` per second. A particle
+// is recycled when its lifetime runs out; when the ring is full the oldest
+// one is overwritten, so nothing is allocated after init(). They collide
+// with halfspaces only, in their own pass, and draw in one instanced batch.
+
+struct FizziksParticle {
+    Vector2 position;
+    Vector2 velocity;
+    float   age;
+    float   lifetime;
+};
+
+struct FizziksEmitter {
+    bool    enabled = false;
+    Vector2 position{ 150, 450 };
+    float   directionDeg = -60.0f;      // cone axis, 0 = +X, negative is up
+    float   spreadDeg = 15.0f;          // half-angle of the cone
+    float   speedMin = 300.0f;          // px/s, uniform in [min, max]
+    float   speedMax = 500.0f;
+    float   rate = 2000.0f;             // particles/second
+    float   lifetime = 3.0f;            // seconds
+    float   radius = 3.0f;
+    float   restitution = 0.3f;
+    Color   color = SKYBLUE;
+
+    void init(int capacity) {
+        ring.assign(capacity, FizziksParticle{});
+        head = count = 0;
+        spawnCarry = 0.0f;
+    }
+
+    int alive() const { return count; }
+    int capacity() const { return (int)ring.size(); }
+
+    void update(float h, Vector2 gravity, const FizziksVector<FizziksHalfspace*, MEM_BROADPHASE>& planes) {
+        int cap = (int)ring.size();
+        if (cap == 0) return;
+
+        // Retire expired particles from the old end of the ring
+        while (count > 0 && ring[head].age >= ring[head].lifetime) {
+            head = (head + 1) % cap;
+            --count;
+        }
+
+        // Spawn; fractional particles carry over to the next step
+        if (enabled) {
+            spawnCarry += rate * h;
+            int n = (int)spawnCarry;
+            spawnCarry -= (float)n;
+            std::uniform_real_distribution<float> angle(directionDeg - spreadDeg, directionDeg + spreadDeg);
+            std::uniform_real_distribution<float> speed(speedMin, speedMax);
+            for (int i = 0; i < n; ++i) {
+                if (count == cap) { head = (head + 1) % cap; --count; }     // reuse the oldest
+                FizziksParticle& p = ring[(head + count++) % cap];
+                float a = angle(rng) * DEG2RAD;
+                p.position = position;
+                p.velocity = Vector2Scale(Vector2{ cosf(a), sinf(a) }, speed(rng));
+                p.age = 0.0f;
+                p.lifetime = lifetime;
+            }
+        }
+
+        // Semi-implicit Euler, then push out of every halfspace with a bounce
+        for (int i = 0; i < count; ++i) {
+            FizziksParticle& p = ring[(head + i) % cap];
+            p.age += h;
+            p.velocity = Vector2Add(p.velocity, Vector2Scale(gravity, h));
+            p.position = Vector2Add(p.position, Vector2Scale(p.velocity, h));
+            for (const FizziksHalfspace* plane : planes) {
+                Vector2 n = plane->getNormal();
+                float d = Vector2Dot(Vector2Subtract(p.position, plane->position), n) - radius;
+                if (d >= 0.0f) continue;
+                p.position = Vector2Subtract(p.position, Vector2Scale(n, d));
+                float vn = Vector2Dot(p.velocity, n);
+                if (vn < 0.0f) p.velocity = Vector2Subtract(p.velocity, Vector2Scale(n, (1.0f + restitution) * vn));
+            }
+        }
+    }
+
+    // Call inside BeginMode2D; one instanced draw for all visible particles
+    void draw(Rectangle view, float pixelSize) {
+        int cap = (int)ring.size();
+        for (int i = 0; i < count; ++i) {
+            const FizziksParticle& p = ring[(head + i) % cap];
+            if (p.age >= p.lifetime) continue;
+            if (p.position.x + radius < view.x || p.position.x - radius > view.x + view.width ||
+                p.position.y + radius < view.y || p.position.y - radius > view.y + view.height) continue;
+            Color c = Fade(color, 1.0f - p.age / p.lifetime);
+            if (gCircleRenderer.ready) gCircleRenderer.push(p.position, radius, c);
+            else DrawCircleV(p.position, radius, c);
+        }
+        gCircleRenderer.flush(pixelSize);
+    }
+
+private:
+    FizziksVector<FizziksParticle, MEM_PARTICLES> ring;
+    int   head = 0;                     // oldest live particle
+    int   count = 0;
+    float spawnCarry = 0.0f;
+    std::mt19937 rng{ 2005 };
+};
+
+static FizziksEmitter gEmitter;
+
+//   Trails
+// Every dynamic body records its path into a fixed-size ring of vertices;
+// when the ring is full the oldest vertex is overwritten, so recording never
+// stops. Samples are decimated as they arrive (a one-pass Douglas-Peucker):
+// the samples since the last vertex stay pending while all of them are
+// within `tolerance` of the segment from that vertex to the newest sample;
+// once one strays, the previous sample becomes a vertex. A straight run
+// costs one vertex, curves keep their shape. All trails draw as one line
+// batch.
+
+static float DistanceToSegment(Vector2 p, Vector2 a, Vector2 b)
+{
+    Vector2 ab = Vector2Subtract(b, a);
+    float len2 = Vector2Dot(ab, ab);
+    float t = len2 > 0.0f ? Clamp(Vector2Dot(Vector2Subtract(p, a), ab) / len2, 0.0f, 1.0f) : 0.0f;
+    return Vector2Distance(p, Vector2Add(a, Vector2Scale(ab, t)));
+}
+
+struct FizziksTrailRecorder {
+    bool  enabled = true;
+    float tolerance = 0.5f;             // px, farthest a dropped sample may be from the line
+    Color color = { 200, 200, 200, 255 };
+
+    // Storage per body: pointsPerTrail vertices + maxPending pending samples
+    void init(int pointsPerTrail, int pendingPerTrail) {
+        capacity = pointsPerTrail;
+        maxPending = pendingPerTrail;
+        clear();
+    }
+
+    void clear() {
+        trails.clear();
+        points.clear();
+        pending.clear();
+        slotOfId.clear();
+        freeSlots.clear();
+        samples = 0;
+    }
+
+    void record(const FizziksObjektList& objekts) {
+        ++frame;
+        for (auto* o : objekts) {
+            if (o->isStatic || o->Shape() == HALF_SPACE) continue;
+            ++samples;
+            Vector2 p = o->position;
+
+            int s = slotFor(o->id);
+            Trail& t = trails[s];
+            t.lastSeen = frame;
+            Vector2* ring = &points[(size_t)s * capacity];
+            Vector2* run = &pending[(size_t)s * maxPending];
+            if (t.count == 0) { pushVertex(t, ring, p); continue; }
+
+            // Does vertex -> p still cover every pending sample?
+            Vector2 a = ring[(t.start + t.count - 1) % capacity];
+            bool covered = t.pendingCount < maxPending;
+            for (int k = 0; covered && k < t.pendingCount; ++k)
+                covered = DistanceToSegment(run[k], a, p) <= tolerance;
+
+            if (!covered) {
+                pushVertex(t, ring, run[t.pendingCount - 1]);
+                t.pendingCount = 0;
+            }
+            run[t.pendingCount++] = p;
+        }
+
+        // Bodies that were not seen (deleted) give their slot back
+        for (int s = 0; s < (int)trails.size(); ++s) {
+            Trail& t = trails[s];
+            if (t.count == 0 || t.lastSeen == frame) continue;
+            slotOfId[t.id] = -1;
+            t.count = 0;
+            freeSlots.push_back(s);
+        }
+    }
+
+    int vertexCount() const {
+        int n = 0;
+        for (const Trail& t : trails) n += t.count + (t.pendingCount > 0 ? 1 : 0);
+        return n;
+    }
+    long long sampleCount() const { return samples; }
+
+    // Call inside BeginMode2D; older segments fade out
+    void draw() {
+        if (!enabled) return;
+        rlBegin(RL_LINES);
+        for (int s = 0; s < (int)trails.size(); ++s) {
+            const Trail& t = trails[s];
+            if (t.count == 0) continue;
+            const Vector2* ring = &points[(size_t)s * capacity];
+            int n = t.count + (t.pendingCount > 0 ? 1 : 0);
+            Vector2 prev = ring[t.start];
+            for (int i = 1; i < n; ++i) {
+                Vector2 next = i < t.count ? ring[(t.start + i) % capacity]
+                                           : pending[(size_t)s * maxPending + t.pendingCount - 1];
+                unsigned char alpha = (unsigned char)(color.a * i / n);
+                rlColor4ub(color.r, color.g, color.b, alpha);
+                rlVertex2f(prev.x, prev.y);
+                rlVertex2f(next.x, next.y);
+                prev = next;
+            }
+        }
+        rlEnd();
+    }
+
+private:
+    struct Trail {
+        unsigned int id = 0;
+        unsigned int lastSeen = 0;
+        int start = 0;                  // oldest vertex in the ring
+        int count = 0;                  // 0 = slot unused
+        int pendingCount = 0;
+    };
+
+    int capacity = 64;
+    int maxPending = 16;
+    FizziksVector<Trail, MEM_TRAILS>   trails;
+    FizziksVector<Vector2, MEM_TRAILS> points;        // capacity per slot
+    FizziksVector<Vector2, MEM_TRAILS> pending;       // maxPending per slot
+    FizziksVector<int, MEM_TRAILS>     slotOfId;
+    FizziksVector<int, MEM_TRAILS>     freeSlots;
+    unsigned int frame = 0;
+    long long    samples = 0;
+
+    int slotFor(unsigned int id) {
+        if (id >= slotOfId.size()) slotOfId.resize(id + 1, -1);
+        int s = slotOfId[id];
+        if (s >= 0) return s;
+        if (!freeSlots.empty()) { s = freeSlots.back(); freeSlots.pop_back(); }
+        else {
+            s = (int)trails.size();
+            trails.emplace_back();
+            points.resize(points.size() + capacity);
+            pending.resize(pending.size() + maxPending);
+        }
+        trails[s] = Trail{};
+        trails[s].id = id;
+        slotOfId[id] = s;
+        return s;
+    }
+
+    void pushVertex(Trail& t, Vector2* ring, Vector2 v) {
+        if (t.count == capacity) { t.start = (t.start + 1) % capacity; --t.count; }
+        ring[(t.start + t.count++) % capacity] = v;
+    }
+};
+
+static FizziksTrailRecorder gTrails;
+
+//   Baked signed distance field
+// Static scenery (halfspaces, terrain, polygons, circles) is baked once into
+// a grid of distance samples at cell corners, negative inside solids, plus
+// a gradient from central differences. A circle against all of it is then
+// one bilinear lookup, whatever the scenery looks like. Only a band around
+// the surfaces is exact; farther away the value is clamped to `band`, which
+// lets terrain use its BVH for the bake. Terrain segments are thin, so
+// their distance is unsigned.
+// Rows are baked as jobs on gJobs. The result is cached on disk
+// under a hash of the inputs, so the next run with the same scene loads it.
+// Circles at least `band` in radius, sensors, and circles whose layers or
+// exclusions let them hit only some of the baked bodies still take the
+// exact pair tests against baked bodies (see FizziksWorld::viaSdf).
+
+static unsigned long long HashBytes(const void* data, size_t size, unsigned long long h)
+{
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0; i < size; ++i) { h ^= p[i]; h *= 1099511628211ull; }      // FNV-1a
+    return h;
+}
+
+// Signed distance to a convex polygon
+static float PolygonDistance(const FizziksPolygon* P, Vector2 p)
+{
+    int n = P->count();
+    float sep = -INFINITY;
+    for (int i = 0; i < n; ++i)
+        sep = fmaxf(sep, Vector2Dot(Vector2Subtract(p, P->vertex(i)), P->normals[i]));
+    if (sep <= 0.0f) return sep;                        // inside: nearest face
+    float best = INFINITY;
+    for (int i = 0; i < n; ++i)
+        best = fminf(best, DistanceToSegment(p, P->vertex(i), P->vertex(i + 1 < n ? i + 1 : 0)));
+    return best;
+}
+
+// Distance from p to a static body's surface (signed for solids), or limit
+// when it is further than that
+static float StaticDistance(FizziksObjekt* o, Vector2 p, float limit)
+{
+    float d = limit;
+    switch (o->Shape()) {
+    case CIRCLE:
+        d = fminf(d, Vector2Distance(p, o->position) - ((FizziksCircle*)o)->radius);
+        break;
+    case HALF_SPACE:
+        d = fminf(d, Vector2Dot(Vector2Subtract(p, o->position), ((FizziksHalfspace*)o)->getNormal()));
+        break;
+    case POLYGON:
+        if (p.x < o->boundsMin.x - d || p.x > o->boundsMax.x + d ||
+            p.y < o->boundsMin.y - d || p.y > o->boundsMax.y + d) break;
+        d = fminf(d, PolygonDistance((FizziksPolygon*)o, p));
+        break;
+    case TERRAIN:
+        ((FizziksTerrain*)o)->query(Vector2{ p.x - d, p.y - d }, Vector2{ p.x + d, p.y + d },
+            [&](Vector2 a, Vector2 b) { d = fminf(d, DistanceToSegment(p, a, b)); });
+        break;
+    }
+    return d;
+}
+
+// Where baked data is cached between runs: fizziks_cache next to the
+// executable, created on first use
+static const char* FizziksCacheDir()
+{
+    static const std::string dir = std::string(GetApplicationDirectory()) + "fizziks_cache";
+    if (!DirectoryExists(dir.c_str())) MakeDirectory(dir.c_str());
+    return dir.c_str();
+}
+
+// Query helpers. Rays take a unit direction and report the entry distance
+// and the surface normal there (t = 0 when the ray starts inside).
+
+static bool RayCircle(const FizziksCircle* c, Vector2 origin, Vector2 d, float& t, Vector2& normal)
+{
+    Vector2 m = Vector2Subtract(origin, c->position);
+    float b = Vector2Dot(m, d);
+    float cc = Vector2Dot(m, m) - c->radius * c->radius;
+    if (cc <= 0.0f) t = 0.0f;                 // starts inside
+    else {
+        if (b > 0.0f) return false;           // pointing away
+        float disc = b * b - cc;
+        if (disc < 0.0f) return false;
+        t = -b - sqrtf(disc);
+    }
+    normal = Vector2Normalize(Vector2Subtract(Vector2Add(origin, Vector2Scale(d, t)), c->position));
+    return true;
+}
+
+// Clipped against every edge's half-plane (Cyrus-Beck)
+static bool RayPolygon(const FizziksPolygon* P, Vector2 origin, Vector2 d, float maxT, float& t, Vector2& normal)
+{
+    float tEnter = 0.0f, tExit = maxT;
+    normal = Vector2Negate(d);
+    for (int i = 0; i < P->count(); ++i) {
+        Vector2 n = P->normals[i];
+        float dist = Vector2Dot(Vector2Subtract(origin, P->vertex(i)), n);     // > 0: outside this edge
+        float dn = Vector2Dot(d, n);
+        if (fabsf(dn) < 1e-12f) {
+            if (dist > 0.0f) return false;    // parallel and outside
+            continue;
+        }
+        float te = -dist / dn;
+        if (dn < 0.0f) {
+            if (te > tEnter) { tEnter = te; normal = n; }
+        }
+        else if (te < tExit) tExit = te;
+        if (tEnter > tExit) return false;
+    }
+    t = tEnter;
+    return true;
+}
+
+static bool RaySegment(Vector2 a, Vector2 b, Vector2 origin, Vector2 d, float& t, Vector2& normal)
+{
+    Vector2 e = Vector2Subtract(b, a);
+    float den = d.x * e.y - d.y * e.x;
+    if (fabsf(den) < 1e-12f) return false;   // parallel
+    Vector2 ao = Vector2Subtract(a, origin);
+    float tr = (ao.x * e.y - ao.y * e.x) / den;
+    float u = (ao.x * d.y - ao.y * d.x) / den;
+    if (tr < 0.0f || u < 0.0f || u > 1.0f) return false;
+    t = tr;
+    normal = Vector2Normalize(Vector2{ e.y, -e.x });
+    if (Vector2Dot(normal, d) > 0.0f) normal = Vector2Negate(normal);   // facing the ray
+    return true;
+}
+
+// Separating axes: the box's own (its bounds) and the polygon's edge normals
+static bool PolygonOverlapsBox(const FizziksPolygon* P, Vector2 min, Vector2 max)
+{
+    if (P->boundsMax.x < min.x || P->boundsMin.x > max.x || P->boundsMax.y < min.y || P->boundsMin.y > max.y) return false;
+    for (int i = 0; i < P->count(); ++i) {
+        Vector2 n = P->normals[i];
+        Vector2 deepest{ n.x > 0 ? min.x : max.x, n.y > 0 ? min.y : max.y };
+        if (Vector2Dot(Vector2Subtract(deepest, P->vertex(i)), n) > 0.0f) return false;
+    }
+    return true;
+}
+
+// Segment clipped to the box slabs (Liang-Barsky)
+static bool SegmentOverlapsBox(Vector2 a, Vector2 b, Vector2 min, Vector2 max)
+{
+    float t0 = 0.0f, t1 = 1.0f;
+    const float p[2] = { a.x, a.y }, e[2] = { b.x - a.x, b.y - a.y };
+    const float lo[2] = { min.x, min.y }, hi[2] = { max.x, max.y };
+    for (int axis = 0; axis < 2; ++axis) {
+        if (fabsf(e[axis]) < 1e-12f) {
+            if (p[axis] < lo[axis] || p[axis] > hi[axis]) return false;
+            continue;
+        }
+        float ta = (lo[axis] - p[axis]) / e[axis];
+        float tb = (hi[axis] - p[axis]) / e[axis];
+        if (ta > tb) { float tmp = ta; ta = tb; tb = tmp; }
+        t0 = fmaxf(t0, ta);
+        t1 = fminf(t1, tb);
+        if (t0 > t1) return false;
+    }
+    return true;
+}
+
+struct FizziksSdf {
+    Vector2 origin{ 0, 0 };
+    float   cellSize = 4.0f;
+    float   band = 64.0f;               // exact within this distance of a surface
+    int     cols = 0;                   // samples per row
+    int     rows = 0;
+    FizziksVector<float, MEM_SHAPES>   dist;
+    FizziksVector<Vector2, MEM_SHAPES> grad;
+    double  bakeSeconds = 0.0;
+    bool    fromCache = false;
+
+    bool ready() const { return !dist.empty(); }
+
+    // Distance at p and the unit direction away from the nearest surface;
+    // INFINITY outside the baked area
+    float sample(Vector2 p, Vector2& normal) const {
+        float fx = (p.x - origin.x) / cellSize;
+        float fy = (p.y - origin.y) / cellSize;
+        if (!(fx >= 0.0f && fy >= 0.0f && fx < cols - 1 && fy < rows - 1)) return INFINITY;
+        int ix = (int)fx, iy = (int)fy;
+        float tx = fx - ix, ty = fy - iy;
+        int i = iy * cols + ix;
+
+        float d0 = dist[i] + (dist[i + 1] - dist[i]) * tx;
+        float d1 = dist[i + cols] + (dist[i + cols + 1] - dist[i + cols]) * tx;
+        Vector2 g0 = Vector2Lerp(grad[i], grad[i + 1], tx);
+        Vector2 g1 = Vector2Lerp(grad[i + cols], grad[i + cols + 1], tx);
+        normal = Vector2Normalize(Vector2Lerp(g0, g1, ty));
+        return d0 + (d1 - d0) * ty;
+    }
+
+    // Bakes statics over area, or loads the same bake from cacheDir when it
+    // is there (pass nullptr to skip the cache)
+    void bake(const std::vector<FizziksObjekt*>& statics, Rectangle area, float cell, const char* cacheDir) {
+        auto t0 = std::chrono::steady_clock::now();
+        origin = Vector2{ area.x, area.y };
+        cellSize = cell;
+        cols = (int)ceilf(area.width / cell) + 1;
+        rows = (int)ceilf(area.height / cell) + 1;
+
+        unsigned long long key = hashScene(statics);
+        const char* path = cacheDir ? TextFormat("%s/fizziks_sdf_%016llx.bin", cacheDir, key) : nullptr;
+        fromCache = path && load(path, key);
+        if (!fromCache) {
+            dist.assign((size_t)cols * rows, band);
+            gJobs.parallelFor(rows, 8, [&](int begin, int end) {
+                for (int y = begin; y < end; ++y) bakeRow(statics, y);
+            });
+            if (path) save(path, key);
+        }
+        computeGradient();
+        bakeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+private:
+    struct FileHeader {
+        char  magic[4];
+        unsigned long long key;
+        int   cols, rows;
+    };
+
+    unsigned long long hashScene(const std::vector<FizziksObjekt*>& statics) const {
+        unsigned long long h = 14695981039346656037ull;
+        const float params[5] = { origin.x, origin.y, cellSize, band, (float)cols * rows };
+        h = HashBytes(params, sizeof(params), h);
+        for (auto* o : statics) {
+            FizziksShape shape = o->Shape();
+            h = HashBytes(&shape, sizeof(shape), h);
+            h = HashBytes(&o->position, sizeof(Vector2), h);
+            if (shape == CIRCLE) h = HashBytes(&((FizziksCircle*)o)->radius, sizeof(float), h);
+            else if (shape == HALF_SPACE) {
+                Vector2 n = ((FizziksHalfspace*)o)->getNormal();
+                h = HashBytes(&n, sizeof(n), h);
+            }
+            else if (shape == POLYGON) {
+                const auto& v = ((FizziksPolygon*)o)->local;
+                h = HashBytes(v.data(), v.size() * sizeof(Vector2), h);
+            }
+            else {
+                const auto& v = ((FizziksTerrain*)o)->points;
+                h = HashBytes(v.data(), v.size() * sizeof(Vector2), h);
+            }
+        }
+        return h;
+    }
+
+    void bakeRow(const std::vector<FizziksObjekt*>& statics, int y) {
+        for (int x = 0; x < cols; ++x) {
+            Vector2 p{ origin.x + x * cellSize, origin.y + y * cellSize };
+            float d = band;
+            for (auto* o : statics) d = StaticDistance(o, p, d);
+            dist[(size_t)y * cols + x] = d;
+        }
+    }
+
+    void computeGradient() {
+        grad.assign(dist.size(), Vector2{ 0, 0 });
+        for (int y = 0; y < rows; ++y) {
+            for (int x = 0; x < cols; ++x) {
+                int xl = x > 0 ? x - 1 : x, xr = x + 1 < cols ? x + 1 : x;
+                int yu = y > 0 ? y - 1 : y, yd = y + 1 < rows ? y + 1 : y;
+                grad[(size_t)y * cols + x] = Vector2{
+                    (dist[(size_t)y * cols + xr] - dist[(size_t)y * cols + xl]) / ((xr - xl) * cellSize),
+                    (dist[(size_t)yd * cols + x] - dist[(size_t)yu * cols + x]) / ((yd - yu) * cellSize) };
+            }
+        }
+    }
+
+    bool load(const char* path, unsigned long long key) {
+        if (!FileExists(path)) return false;
+        int size = 0;
+        unsigned char* data = LoadFileData(path, &size);
+        if (!data) return false;
+        FileHeader header;
+        bool ok = size == (int)(sizeof(FileHeader) + (size_t)cols * rows * sizeof(float));
+        if (ok) {
+            memcpy(&header, data, sizeof(header));
+            ok = memcmp(header.magic, "FSDF", 4) == 0 && header.key == key && header.cols == cols && header.rows == rows;
+        }
+        if (ok) {
+            dist.resize((size_t)cols * rows);
+            memcpy(dist.data(), data + sizeof(FileHeader), dist.size() * sizeof(float));
+        }
+        UnloadFileData(data);
+        return ok;
+    }
+
+    void save(const char* path, unsigned long long key) {
+        std::vector<unsigned char> data(sizeof(FileHeader) + dist.size() * sizeof(float));
+        FileHeader header{ { 'F', 'S', 'D', 'F' }, key, cols, rows };
+        memcpy(data.data(), &header, sizeof(header));
+        memcpy(data.data() + sizeof(header), dist.data(), dist.size() * sizeof(float));
+        SaveFileData(path, data.data(), (int)data.size());
+    }
+};
+
+//   Render snapshot
+// Everything drawing needs from one step, copied out of the world when the
+// step ends: flat arrays of render fields, no body pointers except the
+// terrain (static, never moved or deleted). The world can then run the
+// next step on another thread while this one is drawn.
+struct FizziksRenderSnapshot {
+    struct Circle {
+        Vector2 position;
+        float   radius;                 // < 0: the slot of a non-circle body
+        Color   color;
+        unsigned int id;
+        Vector2 velocity, gravity, normal, friction;    // debug vectors
+    };
+    struct Shape {
+        FizziksShape shape;
+        Color color;
+        int   first, count;             // into vertices (halfspace: position, normal)
+        const FizziksTerrain* terrain;
+    };
+
+    FizziksVector<Circle, MEM_RENDER>  circles;       // one per objekt, same order
+    FizziksVector<Shape, MEM_RENDER>   shapes;        // halfspaces, polygons and terrain
+    FizziksVector<Vector2, MEM_RENDER> vertices;
+    FizziksVector<FizziksManifold, MEM_RENDER> manifolds;
+    Rectangle bounds{ 0, 0, 0, 0 };
+
+    // HUD numbers of the same step
+    int    objektCount = 0;
+    float  time = 0.0f;
+    float  lastTime = 0.0f;
+    double stepSeconds = 0.0;
+    FizziksDriftStats drift;
+    int    checkpointCount = 0;
+    int    checkpointInterval = 0;
+    size_t checkpointBytes = 0;
+    bool   scrubbing = false;
+    size_t arenaPeak = 0;
+    size_t arenaCapacity = 0;
+    int    arenaAllocations = 0;
+    bool   neighbourList = false;
+    int    neighbourPairs = 0;
+    float  neighbourRebuildRate = 0.0f;
+    FizziksLocalityStats locality;
+
+    // Call inside BeginMode2D(camera)
+    void draw(const Camera2D& camera);
+
+private:
+    FizziksVector<FizziksVector<int, MEM_RENDER>, MEM_RENDER> visibleChunks;    // draw scratch
+    FizziksVector<int, MEM_RENDER> visible;
+};
+
+struct FizziksWorld {
+private:
+    unsigned int objektCount = 0;
+
+public:
+    FizziksObjektList objekts;
+    // gravity as acceleration (pixels/s^2), +Y down
+    Vector2 accelerationGravity{ 0, 300 };
+    // simulated domain in world units; bodies leaving it are removed.
+    // Independent of the window: the camera decides what is visible.
+    Rectangle bounds{ -300, -300, InitialWidth + 600, InitialHeight + 600 };
+    float timeStep = 1.0f / TARGET_FPS;
+    FizziksIntegrator integrator = INTEGRATOR_SEMI_IMPLICIT_EULER;
+    bool monitorDrift = true;
+    FizziksDriftStats drift;
+
+    ~FizziksWorld() {
+        FizziksCommand c;
+        while (commands.pop(c)) if (c.type == CMD_ADD) delete c.objekt;
+        for (auto* p : objekts) delete p;
+        objekts.clear();
+    }
+
+    void add(FizziksObjekt* obj) {
+        obj->id = objektCount++;
+        obj->updateBounds();
+        objekts.push_back(obj);
+        gridDirty = true;
+        neighboursDirty = true;
+        if (!handlesDirty) handles.push_back((int)objekts.size() - 1);
+    }
+
+    // Room for n more bodies, so a bulk load grows nothing per body
+    void reserve(size_t n) {
+        objekts.reserve(objekts.size() + n);
+        if (!handlesDirty) handles.reserve(handles.size() + n);
+    }
+
+    // Ids are the handles to bodies: objekts is re-sorted and dynamic
+    // circles and polygons swap slots in their pools (see sortBodies), so
+    // outside the step hold on to an id and find() the body when needed.
+    // Static bodies are never moved.
+    FizziksObjekt* find(unsigned int id);
+
+    // Body order: once the pairs of a step reach reorderThreshold times
+    // further across objekts than on the first step measured (the first
+    // one, then the one after each sort), objekts is sorted along a Z-order
+    // curve and the dynamic circles and polygons are moved into their pool
+    // slots in that order, so stepping objekts walks memory forward.
+    // Worlds below reorderMinBodies fit in cache and are left alone.
+    bool  reorderBodies = true;
+    float reorderThreshold = 2.0f;
+    int   reorderMinBodies = 4096;
+    void  sortBodies();
+    const FizziksLocalityStats& getLocalityStats() const { return locality; }
+
+    // Pending mutations from any thread; update() applies them first. Call
+    // applyCommands() directly to apply them without stepping (paused).
+    FizziksCommandQueue commands{ 4096 };
+    void applyCommands();
+
+    void update();
+    void integrate(float h);
+    void sampleDrift();
+
+    void checkCollisions();
+    void cleanupOffscreen();
+
+    // Copies what drawing needs into snap; the world is free to step again
+    // as soon as this returns
+    void writeSnapshot(FizziksRenderSnapshot& snap);
+
+    // Scratch memory of writeSnapshot(), reset once per snapshot. A step
+    // keeps its transient lists in vectors it reuses (and swaps) instead.
+    const FizziksFrameArena& getFrameArena() const { return frame; }
+    double stepSeconds = 0.0;                       // wall time of the last update()
+
+    // Spatial queries. They reuse the broadphase grid and write into caller
+    // buffers (nothing is allocated); the int versions return how many
+    // objekts were written, at most maxOut. Circles, polygons and halfspaces
+    // are solid; terrain is a line, so rays, boxes and circles can touch it
+    // but a point never lies inside it.
+    bool raycast(Vector2 origin, Vector2 dir, float maxDistance, FizziksRayHit& hit);
+    int  queryPoint(Vector2 p, FizziksObjekt** out, int maxOut);
+    int  queryAABB(Vector2 min, Vector2 max, FizziksObjekt** out, int maxOut);
+    int  queryCircle(Vector2 center, float radius, FizziksObjekt** out, int maxOut);
+
+    void rebuildGrid(float margin = 0.0f);      // margin: AABBs grown for the neighbour list
+    FizziksGrid& getGrid() { return grid; }
+
+    // Verlet neighbour list: the grid pairs whose AABBs come within
+    // neighbourSkin of each other, reused by later steps until some body has
+    // moved more than half the skin from where the list was built (two bodies
+    // closing in then cover at most the skin together). Adding, removing or
+    // restoring bodies and new exclusions rebuild it; call
+    // invalidateNeighbours() after widening a body's category/mask.
+    bool  useNeighbourList = true;
+    float neighbourSkin = 4.0f;
+    void  invalidateNeighbours() { neighboursDirty = true; }
+    const FizziksNeighbourStats& getNeighbourStats() const { return neighbourStats; }
+    const FizziksVector<FizziksHalfspace*, MEM_BROADPHASE>& getHalfspaces() { ensureGrid(); return halfspaces; }
+
+    // Polygon contacts of the last step, and their SAT counters
+    bool useAxisCache = true;
+    FizziksSatStats satStats;
+    const FizziksVector<FizziksManifold, MEM_CONTACTS>& getManifolds() const { return manifolds; }
+
+    // Bakes these static bodies into sdf over bounds; circles then collide
+    // with them through the field only. Sensors are left out (the field
+    // cannot tell which body was hit). The bake is cached in cacheDir,
+    // FizziksCacheDir() by default.
+    FizziksSdf sdf;
+    void bakeSdf(const std::vector<FizziksObjekt*>& statics, float cellSize, const char* cacheDir = FizziksCacheDir());
+    // Circles that meet baked bodies through the field: it is only exact
+    // within band of a surface, sensor circles need the overlap itself, and
+    // the field is the union of the baked bodies, so it stands in for all
+    // of them or none (see sdfFilter)
+    bool viaSdf(const FizziksObjekt* c) const {
+        return sdf.ready() && !c->isSensor && ((const FizziksCircle*)c)->radius < sdf.band &&
+            sdfFilter(c) != SDF_SOME;
+    }
+    // How many of the baked bodies c's layers and exclusions let it hit
+    enum SdfFilter { SDF_NONE, SDF_SOME, SDF_ALL };
+    SdfFilter sdfFilter(const FizziksObjekt* c) const {
+        size_t hits = 0;
+        for (auto* b : sdfBodies) hits += LayersCollide(c, b) && !isExcluded(c, b);
+        return hits == 0 ? SDF_NONE : hits < sdfBodies.size() ? SDF_SOME : SDF_ALL;
+    }
+
+    // Enter/stay/exit events of the last update(), for pairs where either
+    // body is a sensor or has reportContacts set. Stay events are only
+    // written when reportStay is on, so by default the buffer size follows
+    // the number of pair changes.
+    bool reportStay = false;
+    const FizziksVector<FizziksTriggerEvent, MEM_CONTACTS>& getEvents() const { return events; }
+
+    // Pairs that never collide, on top of the category/mask filter
+    void excludePair(FizziksObjekt* a, FizziksObjekt* b) {
+        unsigned long long key = PairKey(a->id, b->id);
+        auto it = std::lower_bound(excludedPairs.begin(), excludedPairs.end(), key);
+        if (it != excludedPairs.end() && *it == key) return;
+        excludedPairs.insert(it, key);
+        a->hasExclusions = b->hasExclusions = true;
+        neighboursDirty = true;
+    }
+    bool isExcluded(const FizziksObjekt* a, const FizziksObjekt* b) const {
+        if (!a->hasExclusions || !b->hasExclusions) return false;
+        return std::binary_search(excludedPairs.begin(), excludedPairs.end(), PairKey(a->id, b->id));
+    }
+
+    // Sensor/reporting pairs o is currently part of
+    int contactCount(const FizziksObjekt* o) const {
+        int n = 0;
+        for (unsigned long long key : lastPairs)
+            if ((unsigned int)(key >> 32) == o->id || (unsigned int)key == o->id) ++n;
+        return n;
+    }
+
+    // Time scrubbing (see FizziksCheckpoint). Steps are counted by update();
+    // scrubTo() restores the nearest checkpoint at or before the target and
+    // continueScrub() re-simulates the remaining steps under a time budget,
+    // so a long rewind is spread over several frames. Queued commands are
+    // replayed from the command log; changes made to the world directly
+    // (add() after the first step, fields set from outside) are not.
+    int    checkpointInterval = 30;                 // steps
+    size_t checkpointBudget = (size_t)256 << 20;    // bytes
+    long long getStep() const { return stepCount; }
+    long long lastStep() const { return std::max(stepCount, furthestStep); }
+    int    checkpointCount() const { return (int)checkpoints.size(); }
+    size_t checkpointBytes() const;
+    void scrubTo(float seconds);
+    bool scrubbing() const { return scrubTarget >= 0; }
+    void continueScrub(double seconds);
+    // Stepping live from a rewound time starts a new history; drop the old one
+    void discardFuture();
+
+private:
+    FizziksGrid grid;
+    bool gridDirty = true;                          // bodies moved since last build
+
+    struct NeighbourPair { int a, b; };             // objekts indices, a < b
+    FizziksVector<NeighbourPair, MEM_BROADPHASE> neighbours;
+    FizziksVector<NeighbourPair, MEM_BROADPHASE> neighbourSort;     // build scratch
+    FizziksVector<int, MEM_BROADPHASE> neighbourStart;
+    FizziksVector<Vector2, MEM_BROADPHASE> neighbourAnchors;   // positions at the build
+    bool neighboursDirty = true;
+    FizziksNeighbourStats neighbourStats;
+
+    FizziksVector<int, MEM_BODIES> handles;        // per id: index in objekts, -1 = gone
+    bool handlesDirty = true;
+    struct SortKey {
+        unsigned int code;
+        int index;
+        bool operator<(const SortKey& o) const { return code != o.code ? code < o.code : index < o.index; }
+    };
+    FizziksVector<SortKey, MEM_SCRATCH> sortKeys;
+    struct SlotKey {
+        FizziksObjekt* slot;
+        int order;                                  // among the bodies of the type, in objekts
+        bool operator<(const SlotKey& o) const { return slot < o.slot; }
+    };
+    FizziksVector<SlotKey, MEM_SCRATCH> slotKeys;
+    FizziksLocalityStats locality;
+    FizziksVector<FizziksHalfspace*, MEM_BROADPHASE> halfspaces;      // collected with the grid
+    FizziksVector<FizziksTerrain*, MEM_BROADPHASE> terrains;
+    FizziksVector<FizziksObjekt*, MEM_SHAPES> sdfBodies;             // baked into sdf
+    unsigned int queryStamp = 0;
+    FizziksFrameArena frame;                        // transient data of one snapshot
+    FizziksVector<unsigned int, MEM_SCRATCH> removals;              // applyCommands scratch
+
+    FizziksVector<unsigned long long, MEM_CONTACTS> pairs;          // overlapping pairs this step
+    FizziksVector<unsigned long long, MEM_CONTACTS> lastPairs;      // ... and last step (sorted)
+    FizziksVector<FizziksTriggerEvent, MEM_CONTACTS> events;
+    FizziksVector<unsigned long long, MEM_CONTACTS> excludedPairs;  // sorted PairKeys
+
+    struct AxisCacheEntry {
+        unsigned long long key;
+        int axis;
+        bool operator<(const AxisCacheEntry& o) const { return key < o.key; }
+    };
+    FizziksVector<AxisCacheEntry, MEM_CONTACTS> axisCache;          // last step, sorted by key
+    FizziksVector<AxisCacheEntry, MEM_CONTACTS> axisCacheNext;
+    FizziksVector<FizziksManifold, MEM_CONTACTS> manifolds;
+
+    long long stepCount = 0;
+    long long furthestStep = 0;                     // before the last rewind
+    long long scrubTarget = -1;
+    FizziksVector<FizziksCheckpoint, MEM_HISTORY> checkpoints;     // sorted by step
+    FizziksVector<FizziksBodyDesc, MEM_HISTORY> descs;             // shared by all checkpoints
+    FizziksVector<Vector2, MEM_HISTORY> descVertices;
+    FizziksVector<int, MEM_HISTORY> latestDesc;                    // per id, -1 = none yet
+    FizziksVector<FizziksObjekt*, MEM_HISTORY> byId;               // restore scratch
+    FizziksVector<FizziksLoggedCommand, MEM_HISTORY> commandLog;   // sorted by step
+    size_t commandCursor = 0;                       // next entry to replay
+
+    void ensureGrid() { if (gridDirty) rebuildGrid(); }
+    Vector2 circleAcceleration(const FizziksCircle* c, Vector2 pos, Vector2& Fn, Vector2& Ff) const;
+    template <FizziksIntegrator I> void integrateWith(float h);
+    template <FizziksIntegrator I> void integrateRange(float h, int begin, int end);
+    void updateDynamicBounds();
+    bool notePair(FizziksObjekt* A, FizziksObjekt* B);
+    void collidePolygonPair(FizziksObjekt* A, FizziksObjekt* B);
+    void collideCandidate(FizziksObjekt* A, FizziksObjekt* B);
+    bool movedPastSkin();
+    template <class Visit> void forEachGridPair(float margin, Visit&& visit);
+    void buildNeighbours();
+    void updateBodyOrder();
+    template <typename T> void sortPooled(FizziksShape shape);
+    void diffPairs();
+    unsigned int describe(FizziksObjekt* o);
+    FizziksObjekt* newBody(const FizziksBodyDesc& d);
+    void applyDesc(FizziksObjekt* o, const FizziksBodyDesc& d);
+    void executeCommand(const FizziksCommand& c);
+    void saveCheckpoint();
+    void restoreCheckpoint(const FizziksCheckpoint& cp);
+};
+
+static FizziksWorld world;
+static Camera2D gCamera{ { 0, 0 }, { 0, 0 }, 0.0f, 1.0f };   // pan/zoom view onto the world
+static FizziksHalfspace* gGround = nullptr;  // main Halfspace used for friction
+static FizziksCircle* gZone = nullptr;       // trigger zone (sensor)
+static int gInZone = 0;                      // bodies inside, tracked from events
+static bool gPaused = false;                 // P: stop live stepping
+
+// Pipelining: step N+1 runs on gSimThread while the main thread draws the
+// snapshot of step N, so a frame costs max(step, draw) at one step of
+// latency. The front snapshot is drawn, the back one is being written.
+static bool gPipelined = true;               // T: off = step and draw in turn
+static FizziksRenderSnapshot gSnapshots[2];
+static int gFront = 0;
+static double gDrawSeconds = 0.0;
+
+// What the HUD edits. It is applied to the world at the one point of the
+// frame where no step is running (applyUi), never from the widgets directly.
+struct FizziksUiState {
+    float sentGroundAngle = 0.0f;            // last angle pushed as a command
+    float gravityY = 300.0f;
+    int   integrator = INTEGRATOR_SEMI_IMPLICIT_EULER;
+    bool  scrub = false;                     // the time slider moved to scrubTime
+    float scrubTime = 0.0f;
+    char  hover[32] = "";                    // dynamic body under the mouse
+    int   hoverId = -1;
+    bool  neighbourList = true;
+    bool  reorderBodies = true;
+};
+static FizziksUiState gUi;
+
+//   World::update with forces
+
+// Job graph of a step: integrate (parallel, refreshes the bounds it moves)
+// -> collisions (serial, they move pairs of bodies in order) -> cleanup ->
+// bounds of the dynamic bodies (parallel)
+void FizziksWorld::update()
+{
+    auto start = std::chrono::steady_clock::now();
+    applyCommands();
+
+    dt = timeStep;
+    timeAccum += dt;
+
+    // restore colors every frame
+    for (auto* o : objekts) o->color = o->baseColor;
+    events.clear();
+
+    // --- Force-based integration ---
+    integrate(dt);
+
+    checkCollisions();
+    cleanupOffscreen();
+
+    updateDynamicBounds();  // separation moved them; statics never move in a step
+    gridDirty = true;       // separation + cleanup moved/removed bodies
+    if (reorderBodies) updateBodyOrder();
+
+    if (monitorDrift) sampleDrift();
+
+    ++stepCount;
+    if (stepCount > furthestStep) furthestStep = stepCount;
+    if (stepCount % checkpointInterval == 0) saveCheckpoint();
+    stepSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Net acceleration of a circle at pos: gravity, plus the ground's normal
+// force and kinetic friction (F = μN) when resting on gGround. The contact
+// forces are written out for drawing.
+Vector2 FizziksWorld::circleAcceleration(const FizziksCircle* c, Vector2 pos, Vector2& Fn, Vector2& Ff) const
+{
+    Fn = Vector2{ 0, 0 };
+    Ff = Vector2{ 0, 0 };
+
+    if (gGround && !c->isSensor) {
+        Vector2 n = gGround->getNormal();
+
+        // Check if close enough to be considered in contact
+        Vector2 toC = Vector2Subtract(pos, gGround->position);
+        float   dSign = Vector2Dot(toC, n);
+        float   pen = c->radius - dSign;
+
+        if (pen >= -1.0f) { // slightly above still counts as resting on surface
+            // Decompose gravity into normal + tangential components
+            float gNmag = Vector2Dot(accelerationGravity, n);
+            Vector2 gN = Vector2Scale(n, gNmag);
+            Vector2 gT = Vector2Subtract(accelerationGravity, gN);
+
+            // Normal force cancels component of gravity into plane
+            Fn = Vector2Scale(n, -gNmag * c->mass);    // opposite direction
+            float Nmag = Vector2Length(Fn);
+
+            // Kinetic friction magnitude μN, opposite tangential gravity
+            float gTlen = Vector2Length(gT);
+            if (gTlen > 0.0001f && Nmag > 0.0f) {
+                Vector2 dirOppose = Vector2Negate(Vector2Scale(gT, 1.0f / gTlen));
+                float FfMag = c->kFriction * Nmag;
+                Ff = Vector2Scale(dirOppose, FfMag);
+            }
+        }
+    }
+
+    // Net force / mass (gravity force is m*g, so it adds g directly)
+    return Vector2Add(accelerationGravity, Vector2Scale(Vector2Add(Fn, Ff), 1.0f / c->mass));
+}
+
+// Pick the kernel once per step; each one is a separate instantiation, so
+// the per-body loop has no integrator branch
+void FizziksWorld::integrate(float h)
+{
+    switch (integrator) {
+    case INTEGRATOR_EULER:                integrateWith<INTEGRATOR_EULER>(h); break;
+    case INTEGRATOR_SEMI_IMPLICIT_EULER:  integrateWith<INTEGRATOR_SEMI_IMPLICIT_EULER>(h); break;
+    case INTEGRATOR_VELOCITY_VERLET:      integrateWith<INTEGRATOR_VELOCITY_VERLET>(h); break;
+    case INTEGRATOR_RK4:                  integrateWith<INTEGRATOR_RK4>(h); break;
+    default: break;
+    }
+}
+
+// Bodies are independent here, so chunks of them run as jobs
+template <FizziksIntegrator I>
+void FizziksWorld::integrateWith(float h)
+{
+    gJobs.parallelFor((int)objekts.size(), 2048, [&](int begin, int end) {
+        integrateRange<I>(h, begin, end);
+    });
+}
+
+template <FizziksIntegrator I>
+void FizziksWorld::integrateRange(float h, int begin, int end)
+{
+    Vector2 Fn, Ff, unusedN, unusedF;
+
+    for (int i = begin; i < end; ++i) {
+        FizziksObjekt* o = objekts[i];
+        if (o->isStatic) continue;
+
+        if (o->Shape() != CIRCLE) {
+            // default integration for any other dynamic objects
+            o->position = Vector2Add(o->position, Vector2Scale(o->velocity, h));
+            o->velocity = Vector2Add(o->velocity, Vector2Scale(accelerationGravity, h));
+            o->updateBounds();
+            continue;
+        }
+
+        auto* c = (FizziksCircle*)o;
+        Vector2 x = c->position;
+        Vector2 v = c->velocity;
+        Vector2 a = circleAcceleration(c, x, Fn, Ff);
+
+        if constexpr (I == INTEGRATOR_EULER) {
+            // position first, with the old velocity (as in Week 9)
+            c->position = Vector2Add(x, Vector2Scale(v, h));
+            c->velocity = Vector2Add(v, Vector2Scale(a, h));
+        }
+        else if constexpr (I == INTEGRATOR_SEMI_IMPLICIT_EULER) {
+            c->velocity = Vector2Add(v, Vector2Scale(a, h));
+            c->position = Vector2Add(x, Vector2Scale(c->velocity, h));
+        }
+        else if constexpr (I == INTEGRATOR_VELOCITY_VERLET) {
+            Vector2 x1 = Vector2Add(x, Vector2Add(Vector2Scale(v, h), Vector2Scale(a, 0.5f * h * h)));
+            Vector2 a1 = circleAcceleration(c, x1, unusedN, unusedF);
+            c->position = x1;
+            c->velocity = Vector2Add(v, Vector2Scale(Vector2Add(a, a1), 0.5f * h));
+        }
+        else {
+            // RK4 on x' = v, v' = a(x)
+            Vector2 k1x = v, k1v = a;
+            Vector2 k2x = Vector2Add(v, Vector2Scale(k1v, 0.5f * h));
+            Vector2 k2v = circleAcceleration(c, Vector2Add(x, Vector2Scale(k1x, 0.5f * h)), unusedN, unusedF);
+            Vector2 k3x = Vector2Add(v, Vector2Scale(k2v, 0.5f * h));
+            Vector2 k3v = circleAcceleration(c, Vector2Add(x, Vector2Scale(k2x, 0.5f * h)), unusedN, unusedF);
+            Vector2 k4x = Vector2Add(v, Vector2Scale(k3v, h));
+            Vector2 k4v = circleAcceleration(c, Vector2Add(x, Vector2Scale(k3x, h)), unusedN, unusedF);
+
+            Vector2 dx = Vector2Add(Vector2Add(k1x, k4x), Vector2Scale(Vector2Add(k2x, k3x), 2.0f));
+            Vector2 dv = Vector2Add(Vector2Add(k1v, k4v), Vector2Scale(Vector2Add(k2v, k3v), 2.0f));
+            c->position = Vector2Add(x, Vector2Scale(dx, h / 6.0f));
+            c->velocity = Vector2Add(v, Vector2Scale(dv, h / 6.0f));
+        }
+
+        // store for drawing
+        c->Fgravity = Vector2Scale(accelerationGravity, c->mass);
+        c->Fnormal = Fn;
+        c->Ffriction = Ff;
+        c->updateBounds();  // the broadphase reads these next
+    }
+}
+
+// Total energy (kinetic + gravitational, U = -m g.x) and momentum of the
+// dynamic circles, compared against a baseline. The baseline is re-taken
+// whenever the body count, integrator or gravity changes.
+void FizziksWorld::sampleDrift()
+{
+    double energy = 0.0, px = 0.0, py = 0.0, totalMass = 0.0;
+    int bodies = 0;
+    for (auto* o : objekts) {
+        if (o->isStatic || o->Shape() != CIRCLE) continue;
+        double m = o->mass;
+        double vx = o->velocity.x, vy = o->velocity.y;
+        energy += 0.5 * m * (vx * vx + vy * vy);
+        energy -= m * ((double)accelerationGravity.x * o->position.x + (double)accelerationGravity.y * o->position.y);
+        px += m * vx;
+        py += m * vy;
+        totalMass += m;
+        ++bodies;
+    }
+
+    FizziksDriftStats& d = drift;
+    if (bodies != d.bodies || integrator != d.integrator ||
+        accelerationGravity.x != d.gravity.x || accelerationGravity.y != d.gravity.y) {
+        d.bodies = bodies;
+        d.integrator = integrator;
+        d.gravity = accelerationGravity;
+        d.energy0 = energy;
+        d.momentum0x = px;
+        d.momentum0y = py;
+        d.steps = 0;
+    }
+
+    d.energy = energy;
+    d.energyDrift = d.energy0 != 0.0 ? (energy - d.energy0) / fabs(d.energy0) : 0.0;
+    double dpx = px - d.momentum0x, dpy = py - d.momentum0y;
+    d.momentumDrift = totalMass > 0.0 ? sqrt(dpx * dpx + dpy * dpy) / totalMass : 0.0;
+    ++d.steps;
+}
+
+void FizziksWorld::rebuildGrid(float margin)
+{
+    grid.build(objekts, bounds, margin);
+
+    halfspaces.clear();
+    terrains.clear();
+    for (auto* o : objekts) {
+        FizziksShape shape = o->Shape();
+        if (shape == HALF_SPACE) halfspaces.push_back((FizziksHalfspace*)o);
+        else if (shape == TERRAIN) terrains.push_back((FizziksTerrain*)o);
+    }
+
+    gridDirty = margin > 0.0f;  // queries want the exact grid
+}
+
+void FizziksWorld::updateDynamicBounds()
+{
+    gJobs.parallelFor((int)objekts.size(), 4096, [this](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+            if (!objekts[i]->isStatic) objekts[i]->updateBounds();
+    });
+}
+
+// Narrowphase of one broadphase pair
+void FizziksWorld::collideCandidate(FizziksObjekt* A, FizziksObjekt* B)
+{
+    if (A->Shape() == CIRCLE && B->Shape() == CIRCLE) {
+        if ((A->baked && viaSdf(B)) || (B->baked && viaSdf(A))) return;     // via the SDF
+        auto* a = (FizziksCircle*)A, * b = (FizziksCircle*)B;
+        if (CircleCircleOverlap(a, b) && !notePair(A, B)) {
+            A->color = RED; B->color = RED;
+            SeparateCircleCircle(a, b);
+        }
+    }
+    else {
+        collidePolygonPair(A, B);
+    }
+}
+
+bool FizziksWorld::movedPastSkin()
+{
+    float limit = neighbourSkin * 0.5f;
+    std::atomic<bool> moved{ false };
+    gJobs.parallelFor((int)objekts.size(), 16384, [&](int begin, int end) {
+        for (int i = begin; i < end && !moved.load(std::memory_order_relaxed); ++i) {
+            if (Vector2DistanceSqr(objekts[i]->position, neighbourAnchors[i]) > limit * limit) {
+                moved.store(true, std::memory_order_relaxed);
+            }
+        }
+    });
+    return moved.load();
+}
+
+// Every pair from the grid whose AABBs, grown by margin each, overlap and
+// whose layers and exclusions let them collide, once: visit(i, j) with
+// objekts indices. A pair sharing several cells is visited only in the cell
+// holding the min corner of their grown AABB overlap.
+template <class Visit>
+void FizziksWorld::forEachGridPair(float margin, Visit&& visit)
+{
+    float gap = 2.0f * margin;
+
+    // Pairs within a level
+    for (int level = 0; level < grid.levelCount; ++level) {
+        const FizziksGrid::Level& lv = grid.levels[level];
+        for (int cy = 0; cy < lv.rows; ++cy) {
+            for (int cx = 0; cx < lv.cols; ++cx) {
+                int cell = lv.cell(cx, cy);
+                int begin = grid.cellStart[cell], end = grid.cellStart[cell + 1];
+
+                for (int i = begin; i < end; ++i) {
+                    // Layer filter on the grid's flat arrays, before any body is
+                    // touched; a body whose mask matches nothing in the grid
+                    // (e.g. debris that only hits the ground) skips the cell
+                    unsigned int catI = grid.itemCategory[i], maskI = grid.itemMask[i];
+                    if ((maskI & grid.categories) == 0) continue;
+
+                    for (int j = i + 1; j < end; ++j) {
+                        if (!(catI & grid.itemMask[j]) || !(grid.itemCategory[j] & maskI)) continue;
+
+                        FizziksObjekt* A = objekts[grid.items[i]];
+                        FizziksObjekt* B = objekts[grid.items[j]];
+                        if (isExcluded(A, B)) continue;
+
+                        if (A->boundsMax.x + gap < B->boundsMin.x || B->boundsMax.x + gap < A->boundsMin.x ||
+                            A->boundsMax.y + gap < B->boundsMin.y || B->boundsMax.y + gap < A->boundsMin.y) continue;
+
+                        float ownerX = fmaxf(A->boundsMin.x, B->boundsMin.x) - margin;
+                        float ownerY = fmaxf(A->boundsMin.y, B->boundsMin.y) - margin;
+                        if (lv.cellX(ownerX) != cx || lv.cellY(ownerY) != cy) continue;
+
+                        visit(grid.items[i], grid.items[j]);
+                    }
+                }
+            }
+        }
+    }
+
+    // Pairs across levels: each body looks down into the finer levels in
+    // use, in the cells its AABB covers there, with the owner cell taken in
+    // the finer level. Large bodies are the few, so this touches far less
+    // than every small body looking up.
+    if ((grid.occupied & (grid.occupied - 1)) == 0) return;      // one level
+    int finest = 0;
+    while (!grid.inUse(finest)) ++finest;
+    for (int i = 0; i < (int)objekts.size(); ++i) {
+        int level = grid.objektLevel[i];
+        if (level <= finest) continue;
+        FizziksObjekt* B = objekts[i];
+        if ((B->mask & grid.categories) == 0) continue;
+
+        for (int fine = finest; fine < level; ++fine) {
+            if (!grid.inUse(fine)) continue;
+            const FizziksGrid::Level& lv = grid.levels[fine];
+            int x0 = lv.cellX(B->boundsMin.x - margin), x1 = lv.cellX(B->boundsMax.x + margin);
+            int y0 = lv.cellY(B->boundsMin.y - margin), y1 = lv.cellY(B->boundsMax.y + margin);
+            for (int cy = y0; cy <= y1; ++cy) {
+                for (int cx = x0; cx <= x1; ++cx) {
+                    int cell = lv.cell(cx, cy);
+                    for (int k = grid.cellStart[cell]; k < grid.cellStart[cell + 1]; ++k) {
+                        if (!(grid.itemCategory[k] & B->mask) || !(B->category & grid.itemMask[k])) continue;
+
+                        FizziksObjekt* A = objekts[grid.items[k]];
+                        if (A->boundsMax.x + gap < B->boundsMin.x || B->boundsMax.x + gap < A->boundsMin.x ||
+                            A->boundsMax.y + gap < B->boundsMin.y || B->boundsMax.y + gap < A->boundsMin.y) continue;
+                        if (isExcluded(A, B)) continue;
+
+                        float ownerX = fmaxf(A->boundsMin.x, B->boundsMin.x) - margin;
+                        float ownerY = fmaxf(A->boundsMin.y, B->boundsMin.y) - margin;
+                        if (lv.cellX(ownerX) != cx || lv.cellY(ownerY) != cy) continue;
+
+                        visit(grid.items[k], i);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Grid on AABBs grown by half the skin each, then the same pair pass as the
+// direct one collecting the pairs
+void FizziksWorld::buildNeighbours()
+{
+    float margin = neighbourSkin * 0.5f;
+    rebuildGrid(margin);
+
+    neighbourSort.clear();
+    forEachGridPair(margin, [&](int a, int b) { neighbourSort.push_back(NeighbourPair{ std::min(a, b), std::max(a, b) }); });
+
+    // In index order, so a step solves its pairs in the same order whenever
+    // the list was built (a replay from a checkpoint builds it at other
+    // steps). Counting sort on a; the few pairs of one a by insertion on b.
+    neighbourStart.assign(objekts.size() + 1, 0);
+    for (const NeighbourPair& p : neighbourSort) ++neighbourStart[p.a + 1];
+    for (size_t i = 1; i < neighbourStart.size(); ++i) neighbourStart[i] += neighbourStart[i - 1];
+    neighbours.resize(neighbourSort.size());
+    for (const NeighbourPair& p : neighbourSort) neighbours[neighbourStart[p.a]++] = p;
+    for (int i = 0, begin = 0; i < (int)objekts.size(); begin = neighbourStart[i++]) {
+        for (int j = begin + 1; j < neighbourStart[i]; ++j) {
+            NeighbourPair p = neighbours[j];
+            int k = j;
+            for (; k > begin && neighbours[k - 1].b > p.b; --k) neighbours[k] = neighbours[k - 1];
+            neighbours[k] = p;
+        }
+    }
+
+    neighbourAnchors.resize(objekts.size());
+    for (size_t i = 0; i < objekts.size(); ++i) neighbourAnchors[i] = objekts[i]->position;
+    neighboursDirty = false;
+    ++neighbourStats.rebuilds;
+    neighbourStats.pairs = (int)neighbours.size();
+}
+
+void FizziksWorld::checkCollisions()
+{
+    bool useList = useNeighbourList && neighbourSkin > 0.0f;
+    if (useList) {
+        if (neighboursDirty || neighbourAnchors.size() != objekts.size() || movedPastSkin()) buildNeighbours();
+        ++neighbourStats.steps;
+    }
+    else {
+        rebuildGrid();
+        neighboursDirty = true;
+    }
+
+    satStats = FizziksSatStats{};
+    manifolds.clear();
+    pairs.clear();
+    axisCacheNext.clear();
+
+    // Pairs from the neighbour list: layers can have narrowed since the
+    // build, the AABBs are tested as they are now
+    long long distanceSum = 0, distancePairs = 0;
+    if (useList) {
+        for (const NeighbourPair& p : neighbours) {
+            FizziksObjekt* A = objekts[p.a];
+            FizziksObjekt* B = objekts[p.b];
+            if (!LayersCollide(A, B)) continue;
+            if (A->boundsMax.x < B->boundsMin.x || B->boundsMax.x < A->boundsMin.x ||
+                A->boundsMax.y < B->boundsMin.y || B->boundsMax.y < A->boundsMin.y) continue;
+            distanceSum += std::abs(p.b - p.a);
+            ++distancePairs;
+            collideCandidate(A, B);
+        }
+    }
+
+    // Otherwise pairs straight from the grid
+    if (!useList) {
+        forEachGridPair(0.0f, [&](int a, int b) {
+            distanceSum += std::abs(b - a);
+            ++distancePairs;
+            collideCandidate(objekts[a], objekts[b]);
+        });
+    }
+    locality.pairDistance = distancePairs ? (double)distanceSum / distancePairs : 0.0;
+
+    // Halfspaces are infinite: test them against every circle and polygon
+    for (auto* h : halfspaces) {
+        for (auto* o : objekts) {
+            FizziksShape shape = o->Shape();
+            if (shape == HALF_SPACE || shape == TERRAIN || !LayersCollide(o, h) || isExcluded(o, h)) continue;
+            if (shape == CIRCLE) {
+                if (h->baked && viaSdf(o)) continue;
+                auto* c = (FizziksCircle*)o;
+                if (CircleHalfspaceOverlap(c, h) && !notePair(c, h)) {
+                    c->color = RED; h->color = RED;
+                    SeparateCircleHalfspace(c, h);
+                }
+                continue;
+            }
+            FizziksManifold m;
+            if (CollidePolygonHalfspace((FizziksPolygon*)o, h, m) && !notePair(o, h)) {
+                o->color = RED; h->color = RED;
+                SeparateBodies(o, h, m.normal, m.penetration);
+                manifolds.push_back(m);
+            }
+        }
+    }
+
+    // Terrain: each circle walks the BVH with its AABB
+    for (auto* t : terrains) {
+        for (auto* o : objekts) {
+            if (o->Shape() != CIRCLE || o->isStatic || (t->baked && viaSdf(o))) continue;
+            if (o->boundsMax.x < t->boundsMin.x || o->boundsMin.x > t->boundsMax.x ||
+                o->boundsMax.y < t->boundsMin.y || o->boundsMin.y > t->boundsMax.y) continue;
+            if (!LayersCollide(o, t) || isExcluded(o, t)) continue;
+
+            auto* c = (FizziksCircle*)o;
+            bool touched = false;
+            t->query(c->boundsMin, c->boundsMax, [&](Vector2 a, Vector2 b) {
+                if (c->isSensor) {
+                    Vector2 ab = Vector2Subtract(b, a);
+                    float len2 = Vector2Dot(ab, ab);
+                    float u = len2 > 0.0f ? Clamp(Vector2Dot(Vector2Subtract(c->position, a), ab) / len2, 0.0f, 1.0f) : 0.0f;
+                    touched |= Vector2Distance(c->position, Vector2Add(a, Vector2Scale(ab, u))) < c->radius;
+                }
+                else touched |= SeparateCircleSegment(c, a, b);
+            });
+            if (touched && !notePair(c, t)) c->color = RED;
+        }
+    }
+
+    // Baked statics: one field lookup per circle that may hit all of them.
+    // The field does not say which body was hit; that is looked up only
+    // when a contact is reported.
+    if (sdf.ready()) {
+        bool report = false;
+        for (auto* b : sdfBodies) report |= b->reportContacts;
+        for (auto* o : objekts) {
+            if (o->Shape() != CIRCLE || o->isStatic || !viaSdf(o) || sdfFilter(o) != SDF_ALL) continue;
+            auto* c = (FizziksCircle*)o;
+            Vector2 n;
+            float d = sdf.sample(c->position, n);
+            if (d >= c->radius) continue;
+            if (report || c->reportContacts) {
+                for (auto* b : sdfBodies)
+                    if (StaticDistance(b, c->position, c->radius) < c->radius) notePair(c, b);
+            }
+            c->color = RED;
+            c->position = Vector2Add(c->position, Vector2Scale(n, c->radius - d + EPS));
+            float vn = Vector2Dot(c->velocity, n);
+            if (vn < 0) c->velocity = Vector2Subtract(c->velocity, Vector2Scale(n, vn));
+        }
+    }
+
+    std::sort(axisCacheNext.begin(), axisCacheNext.end());
+    axisCache.swap(axisCacheNext);
+
+    diffPairs();
+}
+
+void FizziksWorld::bakeSdf(const std::vector<FizziksObjekt*>& statics, float cellSize, const char* cacheDir)
+{
+    std::vector<FizziksObjekt*> bodies;
+    for (auto* o : statics) {
+        if (!o->isStatic || o->isSensor) continue;
+        o->updateBounds();
+        bodies.push_back(o);
+    }
+    sdf.bake(bodies, bounds, cellSize, cacheDir);
+    for (auto* o : bodies) o->baked = true;
+    sdfBodies.assign(bodies.begin(), bodies.end());
+}
+
+// Polygon vs polygon / circle, starting from last step's separating axis
+void FizziksWorld::collidePolygonPair(FizziksObjekt* A, FizziksObjekt* B)
+{
+    if ((A->baked && B->Shape() == CIRCLE && viaSdf(B)) || (B->baked && A->Shape() == CIRCLE && viaSdf(A))) return;     // via the SDF
+
+    // Lower id first, so a cached axis always means the same edge
+    if (B->id < A->id) std::swap(A, B);
+    unsigned long long key = PairKey(A->id, B->id);
+    int axis = -1;
+    if (useAxisCache) {
+        auto it = std::lower_bound(axisCache.begin(), axisCache.end(), AxisCacheEntry{ key, 0 });
+        if (it != axisCache.end() && it->key == key) axis = it->axis;
+    }
+
+    FizziksManifold m;
+    bool hit, cacheHit;
+    FizziksObjekt* first = A;       // manifold normal points away from it
+    if (A->Shape() == POLYGON && B->Shape() == POLYGON) {
+        hit = CollidePolygons((FizziksPolygon*)A, (FizziksPolygon*)B, axis, cacheHit, m);
+    }
+    else {
+        FizziksObjekt* P = A->Shape() == POLYGON ? A : B;
+        FizziksObjekt* C = P == A ? B : A;
+        hit = CollidePolygonCircle((FizziksPolygon*)P, (FizziksCircle*)C, axis, cacheHit, m);
+        first = P;
+    }
+
+    ++satStats.pairs;
+    if (cacheHit) ++satStats.cacheRejects;
+    axisCacheNext.push_back(AxisCacheEntry{ key, axis });
+    if (!hit || notePair(A, B)) return;
+
+    ++satStats.contacts;
+    A->color = RED; B->color = RED;
+    SeparateBodies(first, first == A ? B : A, m.normal, m.penetration);
+    manifolds.push_back(m);
+}
+
+// Records an overlapping pair if it is reported; returns true when it is a
+// sensor pair, i.e. the caller must not push the bodies apart
+bool FizziksWorld::notePair(FizziksObjekt* A, FizziksObjekt* B)
+{
+    bool sensor = A->isSensor || B->isSensor;
+    if (sensor || A->reportContacts || B->reportContacts) {
+        pairs.push_back(PairKey(A->id, B->id));
+    }
+    return sensor;
+}
+
+// Merge the sorted pair sets of this step and the last one: new keys enter,
+// missing keys exit. Work is O(pairs), independent of the body count.
+void FizziksWorld::diffPairs()
+{
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+    size_t i = 0, j = 0;
+    while (i < lastPairs.size() || j < pairs.size()) {
+        unsigned long long key;
+        FizziksTriggerEventType type;
+        if (j == pairs.size() || (i < lastPairs.size() && lastPairs[i] < pairs[j])) {
+            key = lastPairs[i++];
+            type = TRIGGER_EXIT;
+        }
+        else if (i == lastPairs.size() || pairs[j] < lastPairs[i]) {
+            key = pairs[j++];
+            type = TRIGGER_ENTER;
+        }
+        else {
+            key = pairs[j++];
+            ++i;
+            if (!reportStay) continue;
+            type = TRIGGER_STAY;
+        }
+        events.push_back(FizziksTriggerEvent{ type, (unsigned int)(key >> 32), (unsigned int)key });
+    }
+
+    lastPairs.swap(pairs);
+}
+
+//   Spatial queries
+
+bool FizziksWorld::raycast(Vector2 origin, Vector2 dir, float maxDistance, FizziksRayHit& hit)
+{
+    ensureGrid();
+
+    float len = Vector2Length(dir);
+    if (len <= 0.0f) return false;
+    Vector2 d = Vector2Scale(dir, 1.0f / len);
+
+    hit = FizziksRayHit{};
+    hit.distance = maxDistance;
+
+    // Halfspaces in closed form
+    for (auto* h : halfspaces) {
+        Vector2 n = h->getNormal();
+        float s0 = Vector2Dot(Vector2Subtract(origin, h->position), n);
+        float t;
+        if (s0 <= 0.0f) t = 0.0f;                       // starts inside
+        else {
+            float dn = Vector2Dot(d, n);
+            if (dn >= 0.0f) continue;                   // moving away / parallel
+            t = -s0 / dn;
+        }
+        if (t < hit.distance) {
+            hit.objekt = h;
+            hit.distance = t;
+            hit.normal = n;
+        }
+    }
+
+    // Terrain segments under the ray's box, from the BVH
+    for (auto* tr : terrains) {
+        Vector2 end = Vector2Add(origin, Vector2Scale(d, hit.distance));
+        tr->query(Vector2Min(origin, end), Vector2Max(origin, end), [&](Vector2 a, Vector2 b) {
+            float t;
+            Vector2 normal;
+            if (RaySegment(a, b, origin, d, t, normal) && t < hit.distance) {
+                hit.objekt = tr;
+                hit.distance = t;
+                hit.normal = normal;
+            }
+        });
+    }
+
+    // Circles and polygons: walk the cells the ray crosses (Amanatides-Woo) in each level
+    // in use, over the part of the ray inside that level's content. A hit
+    // found in one level shortens the walk through the next.
+    unsigned int stamp = ++queryStamp;
+    for (int level = 0; level < grid.levelCount; ++level) {
+        if (!grid.inUse(level)) continue;
+        const FizziksGrid::Level& lv = grid.levels[level];
+        const float cs = lv.cellSize;
+        Vector2 gMin = lv.origin;
+
+        float tEnter = 0.0f, tExit = hit.distance;
+        const float o[2] = { origin.x, origin.y }, dd[2] = { d.x, d.y };
+        const float lo[2] = { lv.contentMin.x, lv.contentMin.y };
+        const float hi[2] = { lv.contentMax.x, lv.contentMax.y };
+        for (int axis = 0; axis < 2; ++axis) {
+            if (fabsf(dd[axis]) < 1e-12f) {
+                if (o[axis] < lo[axis] || o[axis] > hi[axis]) tEnter = tExit + 1.0f;
+                continue;
+            }
+            float t0 = (lo[axis] - o[axis]) / dd[axis];
+            float t1 = (hi[axis] - o[axis]) / dd[axis];
+            if (t0 > t1) { float tmp = t0; t0 = t1; t1 = tmp; }
+            tEnter = fmaxf(tEnter, t0);
+            tExit = fminf(tExit, t1);
+        }
+        if (tEnter > tExit) continue;
+
+        Vector2 p = Vector2Add(origin, Vector2Scale(d, tEnter));
+        int cx = lv.cellX(p.x), cy = lv.cellY(p.y);
+        int stepX = d.x > 0 ? 1 : -1, stepY = d.y > 0 ? 1 : -1;
+        float tMaxX = fabsf(d.x) > 1e-12f ? (gMin.x + (cx + (stepX > 0)) * cs - origin.x) / d.x : INFINITY;
+        float tMaxY = fabsf(d.y) > 1e-12f ? (gMin.y + (cy + (stepY > 0)) * cs - origin.y) / d.y : INFINITY;
+        float tDeltaX = fabsf(d.x) > 1e-12f ? cs / fabsf(d.x) : INFINITY;
+        float tDeltaY = fabsf(d.y) > 1e-12f ? cs / fabsf(d.y) : INFINITY;
+
+        for (;;) {
+            int cell = lv.cell(cx, cy);
+            for (int k = grid.cellStart[cell]; k < grid.cellStart[cell + 1]; ++k) {
+                FizziksObjekt* obj = objekts[grid.items[k]];
+                if (obj->queryMark == stamp) continue;
+                obj->queryMark = stamp;
+
+                float t;
+                Vector2 normal;
+                bool hitIt = obj->Shape() == CIRCLE
+                    ? RayCircle((FizziksCircle*)obj, origin, d, t, normal)
+                    : RayPolygon((FizziksPolygon*)obj, origin, d, hit.distance, t, normal);
+                if (hitIt && t < hit.distance) {
+                    hit.objekt = obj;
+                    hit.distance = t;
+                    hit.normal = normal;
+                }
+            }
+
+            // Any hit closer than the next cell boundary lies in a visited cell
+            float tNext = fminf(tMaxX, tMaxY);
+            if (tNext > fminf(tExit, hit.distance)) break;
+
+            // Edge cells extend outwards, so stepping off the grid just means
+            // that axis has no more boundaries to cross
+            if (tMaxX < tMaxY) {
+                if (cx + stepX < 0 || cx + stepX >= lv.cols) tMaxX = INFINITY;
+                else { cx += stepX; tMaxX += tDeltaX; }
+            }
+            else {
+                if (cy + stepY < 0 || cy + stepY >= lv.rows) tMaxY = INFINITY;
+                else { cy += stepY; tMaxY += tDeltaY; }
+            }
+        }
+    }
+
+    if (!hit.objekt) return false;
+    hit.point = Vector2Add(origin, Vector2Scale(d, hit.distance));
+    return true;
+}
+
+int FizziksWorld::queryPoint(Vector2 p, FizziksObjekt** out, int maxOut)
+{
+    ensureGrid();
+    int count = 0;
+
+    for (int level = 0; level < grid.levelCount; ++level) {
+        if (!grid.inUse(level)) continue;
+        const FizziksGrid::Level& lv = grid.levels[level];
+        int cell = lv.cell(lv.cellX(p.x), lv.cellY(p.y));
+        for (int k = grid.cellStart[cell]; k < grid.cellStart[cell + 1] && count < maxOut; ++k) {
+            FizziksObjekt* o = objekts[grid.items[k]];
+            bool inside = o->Shape() == CIRCLE
+                ? Vector2DistanceSqr(p, o->position) <= ((FizziksCircle*)o)->radius * ((FizziksCircle*)o)->radius
+                : PolygonDistance((FizziksPolygon*)o, p) <= 0.0f;
+            if (inside) out[count++] = o;
+        }
+    }
+
+    for (auto* h : halfspaces) {
+        if (count >= maxOut) break;
+        if (Vector2Dot(Vector2Subtract(p, h->position), h->getNormal()) <= 0.0f) out[count++] = h;
+    }
+    return count;
+}
+
+int FizziksWorld::queryAABB(Vector2 min, Vector2 max, FizziksObjekt** out, int maxOut)
+{
+    ensureGrid();
+    int count = 0;
+    unsigned int stamp = ++queryStamp;
+
+    for (int level = 0; level < grid.levelCount; ++level) {
+        if (!grid.inUse(level)) continue;
+        const FizziksGrid::Level& lv = grid.levels[level];
+        int x0 = lv.cellX(min.x), x1 = lv.cellX(max.x);
+        int y0 = lv.cellY(min.y), y1 = lv.cellY(max.y);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                int cell = lv.cell(x, y);
+                for (int k = grid.cellStart[cell]; k < grid.cellStart[cell + 1]; ++k) {
+                    FizziksObjekt* o = objekts[grid.items[k]];
+                    if (o->queryMark == stamp) continue;
+                    o->queryMark = stamp;
+
+                    if (o->Shape() == CIRCLE) {
+                        // Closest point of the box to the centre
+                        auto* c = (FizziksCircle*)o;
+                        Vector2 q{ Clamp(c->position.x, min.x, max.x), Clamp(c->position.y, min.y, max.y) };
+                        if (Vector2DistanceSqr(q, c->position) > c->radius * c->radius) continue;
+                    }
+                    else if (!PolygonOverlapsBox((FizziksPolygon*)o, min, max)) continue;
+
+                    if (count >= maxOut) return count;
+                    out[count++] = o;
+                }
+            }
+        }
+    }
+
+    for (auto* t : terrains) {
+        if (count >= maxOut) break;
+        bool touches = false;
+        t->query(min, max, [&](Vector2 a, Vector2 b) { touches = touches || SegmentOverlapsBox(a, b, min, max); });
+        if (touches) out[count++] = t;
+    }
+
+    // A box touches the solid side if its deepest corner is below the plane
+    for (auto* h : halfspaces) {
+        if (count >= maxOut) break;
+        Vector2 n = h->getNormal();
+        Vector2 deepest{ n.x > 0 ? min.x : max.x, n.y > 0 ? min.y : max.y };
+        if (Vector2Dot(Vector2Subtract(deepest, h->position), n) <= 0.0f) out[count++] = h;
+    }
+    return count;
+}
+
+int FizziksWorld::queryCircle(Vector2 center, float radius, FizziksObjekt** out, int maxOut)
+{
+    ensureGrid();
+    int count = 0;
+    unsigned int stamp = ++queryStamp;
+
+    for (int level = 0; level < grid.levelCount; ++level) {
+        if (!grid.inUse(level)) continue;
+        const FizziksGrid::Level& lv = grid.levels[level];
+        int x0 = lv.cellX(center.x - radius), x1 = lv.cellX(center.x + radius);
+        int y0 = lv.cellY(center.y - radius), y1 = lv.cellY(center.y + radius);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                int cell = lv.cell(x, y);
+                for (int k = grid.cellStart[cell]; k < grid.cellStart[cell + 1]; ++k) {
+                    FizziksObjekt* o = objekts[grid.items[k]];
+                    if (o->queryMark == stamp) continue;
+                    o->queryMark = stamp;
+
+                    if (o->Shape() == CIRCLE) {
+                        float r = radius + ((FizziksCircle*)o)->radius;
+                        if (Vector2DistanceSqr(center, o->position) > r * r) continue;
+                    }
+                    else if (PolygonDistance((FizziksPolygon*)o, center) > radius) continue;
+
+                    if (count >= maxOut) return count;
+                    out[count++] = o;
+                }
+            }
+        }
+    }
+
+    Vector2 reach{ radius, radius };
+    for (auto* t : terrains) {
+        if (count >= maxOut) break;
+        bool touches = false;
+        t->query(Vector2Subtract(center, reach), Vector2Add(center, reach), [&](Vector2 a, Vector2 b) {
+            touches = touches || DistanceToSegment(center, a, b) <= radius;
+        });
+        if (touches) out[count++] = t;
+    }
+
+    for (auto* h : halfspaces) {
+        if (count >= maxOut) break;
+        if (Vector2Dot(Vector2Subtract(center, h->position), h->getNormal()) < radius) out[count++] = h;
+    }
+    return count;
+}
+
+FizziksObjekt* FizziksWorld::find(unsigned int id)
+{
+    if (handlesDirty) {
+        handles.assign(objektCount, -1);
+        for (size_t i = 0; i < objekts.size(); ++i) handles[objekts[i]->id] = (int)i;
+        handlesDirty = false;
+    }
+    return id < handles.size() && handles[id] >= 0 ? objekts[handles[id]] : nullptr;
+}
+
+void FizziksWorld::executeCommand(const FizziksCommand& c)
+{
+    switch (c.type) {
+    case CMD_ADD:
+        add(c.objekt);
+        break;
+    case CMD_REMOVE:
+        removals.push_back(c.id);
+        break;
+    case CMD_SET_GRAVITY:
+        accelerationGravity = c.vector;
+        break;
+    case CMD_SET_ROTATION:
+        if (FizziksObjekt* o = find(c.id))
+            if (o->Shape() == HALF_SPACE) ((FizziksHalfspace*)o)->setRotationDegrees(c.scalar);
+        break;
+    case CMD_SET_INTEGRATOR:
+        integrator = (FizziksIntegrator)c.mode;
+        break;
+    }
+}
+
+// Targets are found through the handle table and removals are one
+// compaction pass. While re-simulating, the logged commands of this step go
+// in first; a new command from the queue then starts a new history here.
+void FizziksWorld::applyCommands()
+{
+    if (checkpoints.empty()) saveCheckpoint();      // step 0, before any input
+
+    removals.clear();
+    for (; commandCursor < commandLog.size() && commandLog[commandCursor].step == stepCount; ++commandCursor) {
+        const FizziksLoggedCommand& l = commandLog[commandCursor];
+        if (l.command.type != CMD_ADD) {
+            executeCommand(l.command);
+            continue;
+        }
+        // Same id as the first time, so later commands and checkpoints match
+        FizziksObjekt* o = newBody(descs[l.state.desc]);
+        applyDesc(o, descs[l.state.desc]);
+        o->position = l.state.position;
+        o->velocity = l.state.velocity;
+        o->updateBounds();
+        objekts.push_back(o);
+        gridDirty = true;
+        neighboursDirty = true;
+        handlesDirty = true;
+    }
+
+    FizziksCommand c;
+    bool first = true;
+    while (commands.pop(c)) {
+        if (first) discardFuture();
+        first = false;
+        executeCommand(c);
+        FizziksLoggedCommand l{ stepCount, c, FizziksBodyState{ 0, { 0, 0 }, { 0, 0 } } };
+        if (c.type == CMD_ADD) {
+            l.command.objekt = nullptr;
+            l.command.id = c.objekt->id;
+            l.state = FizziksBodyState{ describe(c.objekt), c.objekt->position, c.objekt->velocity };
+        }
+        commandLog.push_back(l);
+        commandCursor = commandLog.size();
+    }
+    if (removals.empty()) return;
+
+    std::sort(removals.begin(), removals.end());
+    size_t kept = 0;
+    for (FizziksObjekt* o : objekts) {
+        if (!o->isStatic && std::binary_search(removals.begin(), removals.end(), o->id)) delete o;
+        else objekts[kept++] = o;
+    }
+    objekts.resize(kept);
+    gridDirty = true;
+    neighboursDirty = true;
+    handlesDirty = true;
+}
+
+// Called at the end of a step; the decision only depends on world state
+// that checkpoints keep, so a replay sorts at the same steps
+void FizziksWorld::updateBodyOrder()
+{
+    if ((int)objekts.size() < reorderMinBodies || locality.pairDistance <= 0.0) return;
+    if (locality.baseline == 0.0) locality.baseline = locality.pairDistance;
+    else if (locality.pairDistance > locality.baseline * reorderThreshold) sortBodies();
+}
+
+// Keys in parallel, one sort, then objekts is permuted in place by
+// following the cycles of the sorted indices, and the pooled bodies are
+// moved into slots in the same order
+void FizziksWorld::sortBodies()
+{
+    auto t0 = std::chrono::steady_clock::now();
+    int n = (int)objekts.size();
+    sortKeys.resize(n);
+    gJobs.parallelFor(n, 16384, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) sortKeys[i] = SortKey{ MortonCode(objekts[i]->position, bounds), i };
+    });
+    std::sort(sortKeys.begin(), sortKeys.end());
+
+    // Slot j takes the body from sortKeys[j].index; a done slot points at itself
+    for (int i = 0; i < n; ++i) {
+        if (sortKeys[i].index == i) continue;
+        FizziksObjekt* first = objekts[i];
+        int j = i;
+        for (int from = sortKeys[j].index; from != i; j = from, from = sortKeys[j].index) {
+            objekts[j] = objekts[from];
+            sortKeys[j].index = j;
+        }
+        objekts[j] = first;
+        sortKeys[j].index = j;
+    }
+    sortPooled<FizziksCircle>(CIRCLE);
+    sortPooled<FizziksPolygon>(POLYGON);
+
+    gridDirty = true;
+    neighboursDirty = true;
+    handlesDirty = true;
+    locality.baseline = 0.0;
+    ++locality.sorts;
+    locality.sortSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// The k-th dynamic T in objekts gets the k-th lowest of their slots: the
+// contents go round the cycles of that permutation through one carried
+// body, then objekts points at the new slots
+template <typename T>
+void FizziksWorld::sortPooled(FizziksShape shape)
+{
+    slotKeys.clear();
+    for (auto* o : objekts)
+        if (!o->isStatic && o->Shape() == shape) slotKeys.push_back(SlotKey{ o, (int)slotKeys.size() });
+    std::sort(slotKeys.begin(), slotKeys.end());
+
+    // Slot j holds the body that belongs in slot slotKeys[j].order; a done
+    // slot points at itself
+    for (int j = 0; j < (int)slotKeys.size(); ++j) {
+        if (slotKeys[j].order == j) continue;
+        T carry = std::move(*(T*)slotKeys[j].slot);
+        int t = slotKeys[j].order;
+        slotKeys[j].order = j;
+        while (true) {
+            std::swap(carry, *(T*)slotKeys[t].slot);
+            if (t == j) break;
+            int next = slotKeys[t].order;
+            slotKeys[t].order = t;
+            t = next;
+        }
+    }
+
+    int k = 0;
+    for (auto*& o : objekts)
+        if (!o->isStatic && o->Shape() == shape) o = slotKeys[k++].slot;
+}
+
+void FizziksWorld::cleanupOffscreen()
+{
+    for (int i = 0; i < (int)objekts.size(); ++i) {
+        FizziksObjekt* o = objekts[i];
+        if (o->Shape() == HALF_SPACE || o->Shape() == TERRAIN) continue;
+
+        bool off =
+            (o->position.y > bounds.y + bounds.height) || (o->position.y < bounds.y) ||
+            (o->position.x > bounds.x + bounds.width) || (o->position.x < bounds.x);
+
+        if (off) {
+            delete o;
+            objekts.erase(objekts.begin() + i);
+            neighboursDirty = true;
+            handlesDirty = true;
+            --i;
+        }
+    }
+}
+
+// Circles are copied in parallel chunks; the chunks also list their other
+// bodies, which are few and copied afterwards in order
+void FizziksWorld::writeSnapshot(FizziksRenderSnapshot& snap)
+{
+    frame.reset();
+    const int grain = 4096;
+    int n = (int)objekts.size();
+    int chunks = (n + grain - 1) / grain;
+    snap.circles.resize(n);
+    auto* otherLists = (FizziksScratch<int>*)frame.local().alloc(chunks * sizeof(FizziksScratch<int>));
+    gJobs.parallelFor(chunks, 1, [&](int begin, int end) {
+        for (int k = begin; k < end; ++k) {
+            FizziksScratch<int>& others = otherLists[k];
+            others = FizziksScratch<int>(frame.local());
+            int last = std::min(n, (k + 1) * grain);
+            for (int i = k * grain; i < last; ++i) {
+                FizziksObjekt* o = objekts[i];
+                FizziksRenderSnapshot::Circle& out = snap.circles[i];
+                if (o->Shape() != CIRCLE) {
+                    out.radius = -1.0f;
+                    others.push_back(i);
+                    continue;
+                }
+                auto* c = (FizziksCircle*)o;
+                out = FizziksRenderSnapshot::Circle{ c->position, c->radius, c->color, c->id,
+                    c->velocity, c->Fgravity, c->Fnormal, c->Ffriction };
+            }
+        }
+    });
+
+    snap.shapes.clear();
+    snap.vertices.clear();
+    for (int k = 0; k < chunks; ++k) for (int i : otherLists[k]) {
+        FizziksObjekt* o = objekts[i];
+        FizziksRenderSnapshot::Shape shape{ o->Shape(), o->color, (int)snap.vertices.size(), 0, nullptr };
+        if (shape.shape == HALF_SPACE) {
+            auto* h = (FizziksHalfspace*)o;
+            snap.vertices.push_back(h->position);
+            snap.vertices.push_back(h->getNormal());
+            shape.count = 2;
+        }
+        else if (shape.shape == POLYGON) {
+            auto* poly = (FizziksPolygon*)o;
+            for (int v = 0; v < poly->count(); ++v) snap.vertices.push_back(poly->vertex(v));
+            shape.count = poly->count();
+        }
+        else if (shape.shape == TERRAIN) {
+            shape.terrain = (const FizziksTerrain*)o;
+        }
+        snap.shapes.push_back(shape);
+    }
+
+    snap.manifolds.assign(manifolds.begin(), manifolds.end());
+    snap.bounds = bounds;
+    snap.objektCount = n;
+    snap.time = timeAccum;
+    snap.lastTime = lastStep() * timeStep;
+    snap.stepSeconds = stepSeconds;
+    snap.drift = drift;
+    snap.checkpointCount = checkpointCount();
+    snap.checkpointInterval = checkpointInterval;
+    snap.checkpointBytes = checkpointBytes();
+    snap.scrubbing = scrubbing();
+    snap.arenaPeak = frame.peakBytes();
+    snap.arenaCapacity = frame.capacity();
+    snap.arenaAllocations = frame.heapAllocations();
+    snap.neighbourList = useNeighbourList;
+    snap.neighbourPairs = neighbourStats.pairs;
+    snap.neighbourRebuildRate = neighbourStats.rebuildRate();
+    snap.locality = locality;
+}
+
+void FizziksRenderSnapshot::draw(const Camera2D& camera)
+{
+    // Visible world rectangle (camera is never rotated here)
+    Vector2 viewMin = GetScreenToWorld2D(Vector2{ 0, 0 }, camera);
+    Vector2 viewMax = GetScreenToWorld2D(Vector2{ (float)GetScreenWidth(), (float)GetScreenHeight() }, camera);
+    Rectangle view{ viewMin.x, viewMin.y, viewMax.x - viewMin.x, viewMax.y - viewMin.y };
+
+    DrawRectangleLinesEx(bounds, 1.0f / camera.zoom, DARKGRAY);
+
+    // The few non-circle bodies first; halfspaces and terrain clip themselves
+    for (const Shape& s : shapes) {
+        if (s.shape == HALF_SPACE) FizziksHalfspace::draw(vertices[s.first], vertices[s.first + 1], s.color, view);
+        else if (s.shape == POLYGON) FizziksPolygon::draw(&vertices[s.first], s.count, s.color);
+        else if (s.shape == TERRAIN) s.terrain->draw(view, s.color);
+    }
+
+    // Render prep as jobs: cull chunks of circles against the view, then
+    // gather the visible ones in order
+    const int grain = 4096;
+    int n = (int)circles.size();
+    int chunks = (n + grain - 1) / grain;
+    if ((int)visibleChunks.size() < chunks) visibleChunks.resize(chunks);
+    gJobs.parallelFor(chunks, 1, [&](int begin, int end) {
+        for (int k = begin; k < end; ++k) {
+            FizziksVector<int, MEM_RENDER>& out = visibleChunks[k];
+            out.clear();
+            int last = std::min(n, (k + 1) * grain);
+            for (int i = k * grain; i < last; ++i) {
+                const Circle& c = circles[i];
+                if (c.radius < 0.0f) continue;
+                if (c.position.x + c.radius < viewMin.x || c.position.x - c.radius > viewMax.x ||
+                    c.position.y + c.radius < viewMin.y || c.position.y - c.radius > viewMax.y) continue;
+                out.push_back(i);
+            }
+        }
+    });
+    visible.clear();
+    for (int k = 0; k < chunks; ++k) visible.insert(visible.end(), visibleChunks[k].begin(), visibleChunks[k].end());
+
+    // Second phase: circle instances and debug vectors per chunk of visible
+    // circles. Each chunk has its own debug list, so flush keeps the order.
+    n = (int)visible.size();
+    chunks = (n + grain - 1) / grain;
+    FizziksCircleRenderer::Instance* inst = gCircleRenderer.ready ? gCircleRenderer.append(n) : nullptr;
+    gDebugDraw.setLists(chunks);
+    gJobs.parallelFor(chunks, 1, [&](int begin, int end) {
+        for (int k = begin; k < end; ++k) {
+            int last = std::min(n, (k + 1) * grain);
+            for (int i = k * grain; i < last; ++i) {
+                const Circle& c = circles[visible[i]];
+                if (inst) inst[i] = FizziksCircleRenderer::Instance{ c.position, c.radius, Fade(c.color, 0.6f) };
+                gDebugDraw.push(DEBUG_VELOCITY, c.position, c.velocity, k);
+                gDebugDraw.push(DEBUG_GRAVITY, c.position, c.gravity, k);
+                gDebugDraw.push(DEBUG_NORMAL, c.position, c.normal, k);
+                gDebugDraw.push(DEBUG_FRICTION, c.position, c.friction, k);
+            }
+        }
+    });
+
+    // Spheres go through the instanced renderer when it is available
+    if (!gCircleRenderer.ready) {
+        for (int i : visible) DrawCircleV(circles[i].position, circles[i].radius, Fade(circles[i].color, 0.6f));
+    }
+    else {
+        gCircleRenderer.flush(1.0f / camera.zoom);
+    }
+
+    // Force / velocity vectors on top of the spheres
+    gDebugDraw.flush();
+
+    // Polygon contact points
+    for (const FizziksManifold& m : manifolds)
+        for (int i = 0; i < m.count; ++i) DrawCircleV(m.points[i], 3.0f / camera.zoom, YELLOW);
+
+    // Labels last, in one batch
+    gLabelRenderer.begin(view, camera.zoom);
+    for (int i : visible) {
+        const Circle& c = circles[i];
+        gLabelRenderer.push(c.id, Vector2{ floorf(c.position.x - c.radius), floorf(c.position.y - c.radius * 2) });
+    }
+    gLabelRenderer.flush();
+}
+
+//   Checkpoints / time scrubbing
+
+static bool SameBodyDesc(const FizziksBodyDesc& a, const FizziksBodyDesc& b)
+{
+    return a.id == b.id && a.shape == b.shape && a.isStatic == b.isStatic && a.isSensor == b.isSensor &&
+        a.reportContacts == b.reportContacts && a.hasExclusions == b.hasExclusions &&
+        a.category == b.category && a.mask == b.mask && a.mass == b.mass &&
+        a.radius == b.radius && a.kFriction == b.kFriction && a.rotationDeg == b.rotationDeg &&
+        a.vertexCount == b.vertexCount &&
+        ColorToInt(a.baseColor) == ColorToInt(b.baseColor);
+}
+
+// Descriptor index for o's current properties; reuses the last one when
+// nothing changed
+unsigned int FizziksWorld::describe(FizziksObjekt* o)
+{
+    FizziksBodyDesc d;
+    d.id = o->id;
+    d.shape = o->Shape();
+    d.isStatic = o->isStatic;
+    d.isSensor = o->isSensor;
+    d.reportContacts = o->reportContacts;
+    d.hasExclusions = o->hasExclusions;
+    d.category = o->category;
+    d.mask = o->mask;
+    d.mass = o->mass;
+    d.radius = d.kFriction = d.rotationDeg = 0.0f;
+    d.vertexStart = d.vertexCount = 0;
+    const FizziksPolygon* poly = nullptr;
+    if (d.shape == CIRCLE) {
+        auto* c = static_cast<FizziksCircle*>(o);
+        d.radius = c->radius;
+        d.kFriction = c->kFriction;
+    }
+    else if (d.shape == HALF_SPACE) {
+        d.rotationDeg = static_cast<FizziksHalfspace*>(o)->getRotation();
+    }
+    else if (d.shape == POLYGON) {
+        poly = static_cast<FizziksPolygon*>(o);
+        d.vertexCount = poly->count();
+    }
+    else {
+        d.vertexCount = (int)static_cast<FizziksTerrain*>(o)->points.size();
+    }
+    d.baseColor = o->baseColor;
+
+    if (latestDesc.size() < objektCount) latestDesc.resize(objektCount, -1);
+    int& latest = latestDesc[o->id];
+    // Terrain is static and only set up once: its points are stored with
+    // the first descriptor and not compared again
+    if (latest >= 0 && SameBodyDesc(descs[latest], d) &&
+        (!poly || std::equal(poly->local.begin(), poly->local.end(), descVertices.begin() + descs[latest].vertexStart,
+            [](Vector2 a, Vector2 b) { return a.x == b.x && a.y == b.y; })))
+        return (unsigned int)latest;
+    if (poly) {
+        d.vertexStart = (int)descVertices.size();
+        descVertices.insert(descVertices.end(), poly->local.begin(), poly->local.end());
+    }
+    else if (d.shape == TERRAIN) {
+        const auto& pts = static_cast<FizziksTerrain*>(o)->points;
+        d.vertexStart = (int)descVertices.size();
+        descVertices.insert(descVertices.end(), pts.begin(), pts.end());
+    }
+    latest = (int)descs.size();
+    descs.push_back(d);
+    return (unsigned int)latest;
+}
+
+size_t FizziksWorld::checkpointBytes() const
+{
+    size_t total = descs.capacity() * sizeof(FizziksBodyDesc) + descVertices.capacity() * sizeof(Vector2) +
+        commandLog.capacity() * sizeof(FizziksLoggedCommand);
+    for (const FizziksCheckpoint& cp : checkpoints) total += cp.bytes();
+    return total;
+}
+
+static bool CheckpointBefore(const FizziksCheckpoint& cp, long long step) { return cp.step < step; }
+static bool StepBefore(long long step, const FizziksCheckpoint& cp) { return step < cp.step; }
+
+void FizziksWorld::saveCheckpoint()
+{
+    auto it = std::lower_bound(checkpoints.begin(), checkpoints.end(), stepCount, CheckpointBefore);
+    if (it != checkpoints.end() && it->step == stepCount) return;   // re-simulating: already have it
+
+    it = checkpoints.insert(it, FizziksCheckpoint{});
+    FizziksCheckpoint& cp = *it;
+    cp.step = stepCount;
+    cp.time = timeAccum;
+    cp.gravity = accelerationGravity;
+    cp.integrator = integrator;
+    cp.bodies.resize(objekts.size());
+    for (size_t i = 0; i < objekts.size(); ++i) {
+        FizziksObjekt* o = objekts[i];
+        cp.bodies[i] = FizziksBodyState{ describe(o), o->position, o->velocity };
+    }
+    cp.pairs.assign(lastPairs.begin(), lastPairs.end());
+    cp.localityBaseline = locality.baseline;
+
+    // Over budget: keep every second checkpoint (the first one always stays)
+    while (checkpoints.size() > 2 && checkpointBytes() > checkpointBudget) {
+        size_t keep = 0;
+        for (size_t i = 0; i < checkpoints.size(); i += 2) {
+            if (keep != i) checkpoints[keep] = std::move(checkpoints[i]);
+            ++keep;
+        }
+        checkpoints.resize(keep);
+        checkpointInterval *= 2;
+    }
+}
+
+// A body of d's shape and id; the properties are set by applyDesc()
+FizziksObjekt* FizziksWorld::newBody(const FizziksBodyDesc& d)
+{
+    FizziksObjekt* o;
+    if (d.shape == CIRCLE) o = new FizziksCircle();
+    else if (d.shape == HALF_SPACE) o = new FizziksHalfspace();
+    else if (d.shape == POLYGON) o = new FizziksPolygon();
+    else {
+        auto* t = new FizziksTerrain();
+        t->setPoints(&descVertices[d.vertexStart], d.vertexCount);
+        o = t;
+    }
+    o->id = d.id;
+    return o;
+}
+
+void FizziksWorld::applyDesc(FizziksObjekt* o, const FizziksBodyDesc& d)
+{
+    o->isStatic = d.isStatic;
+    o->isSensor = d.isSensor;
+    o->reportContacts = d.reportContacts;
+    o->hasExclusions = d.hasExclusions;
+    o->category = d.category;
+    o->mask = d.mask;
+    o->mass = d.mass;
+    o->baseColor = o->color = d.baseColor;
+    if (d.shape == CIRCLE) {
+        auto* c = static_cast<FizziksCircle*>(o);
+        c->radius = d.radius;
+        c->kFriction = d.kFriction;
+    }
+    else if (d.shape == HALF_SPACE) {
+        static_cast<FizziksHalfspace*>(o)->setRotationDegrees(d.rotationDeg);
+    }
+    else if (d.shape == POLYGON) {
+        static_cast<FizziksPolygon*>(o)->setVertices(&descVertices[d.vertexStart], d.vertexCount);
+    }
+}
+
+// Bodies are matched by id: survivors are rewritten in place, bodies deleted
+// since the checkpoint are recreated and bodies added after it are deleted.
+// Static bodies are never cleaned up, so pointers to them stay valid.
+// Checkpoints are taken before the commands of their step, so the replay
+// picks up the command log from that step on.
+void FizziksWorld::restoreCheckpoint(const FizziksCheckpoint& cp)
+{
+    byId.assign(objektCount, nullptr);
+    for (auto* o : objekts) byId[o->id] = o;
+
+    FizziksObjektList restored(cp.bodies.size());
+    for (size_t i = 0; i < cp.bodies.size(); ++i) {
+        const FizziksBodyState& s = cp.bodies[i];
+        const FizziksBodyDesc& d = descs[s.desc];
+
+        FizziksObjekt* o = byId[d.id];
+        if (o) byId[d.id] = nullptr;    // claimed; whatever is left gets deleted
+        else o = newBody(d);
+        applyDesc(o, d);
+        o->position = s.position;
+        o->velocity = s.velocity;
+        o->updateBounds();
+        restored[i] = o;
+    }
+    for (auto* o : byId) delete o;
+    objekts.swap(restored);
+
+    stepCount = cp.step;
+    timeAccum = cp.time;
+    accelerationGravity = cp.gravity;
+    integrator = cp.integrator;
+    lastPairs.assign(cp.pairs.begin(), cp.pairs.end());
+    events.clear();
+    locality.baseline = cp.localityBaseline;
+    commandCursor = std::lower_bound(commandLog.begin(), commandLog.end(), cp.step,
+        [](const FizziksLoggedCommand& l, long long step) { return l.step < step; }) - commandLog.begin();
+    gridDirty = true;
+    neighboursDirty = true;
+    handlesDirty = true;
+}
+
+void FizziksWorld::scrubTo(float seconds)
+{
+    long long target = (long long)(seconds / timeStep + 0.5f);
+    target = std::max(0LL, std::min(target, lastStep()));
+
+    // Latest checkpoint at or before the target. When the world already sits
+    // between it and the target, stepping on from here is cheaper.
+    auto it = std::upper_bound(checkpoints.begin(), checkpoints.end(), target, StepBefore);
+    if (it != checkpoints.begin()) {
+        const FizziksCheckpoint& cp = *(it - 1);
+        if (stepCount < cp.step || stepCount > target) restoreCheckpoint(cp);
+    }
+    scrubTarget = stepCount < target ? target : -1;
+}
+
+void FizziksWorld::continueScrub(double seconds)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    while (stepCount < scrubTarget) {
+        update();
+        if (std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() > seconds) break;
+    }
+    if (stepCount >= scrubTarget) scrubTarget = -1;
+}
+
+void FizziksWorld::discardFuture()
+{
+    commandLog.resize(commandCursor);
+    if (furthestStep == stepCount) return;
+    auto it = std::upper_bound(checkpoints.begin(), checkpoints.end(), stepCount, StepBefore);
+    checkpoints.erase(it, checkpoints.end());
+    furthestStep = stepCount;
+}
+
+//   Scene files
+// Scenes are authored as text and can be compiled to a binary form that
+// loads with one file read and one copy per array. load() takes either.
+// Text is one entry per line, '#' starts a comment, [..] is optional:
+//
+//   world [gravity x y] [timestep s] [bounds x y w h] [integrator euler|semi-implicit|verlet|rk4]
+//   material <name> [mass m] [friction mu] [radius r] [color <raylib name> | color r g b [a]]
+//   circle <material> x y [velocity vx vy] [static] [sensor] [category L] [mask L] [name N]
+//   halfspace <material> x y [angle deg] [category L] [mask L] [name N]
+//   grid <material> x y cols rows spacing        (cols x rows circles)
+//   emitter x y [rate r] [direction deg] [spread deg] [on]
+//
+// Layers are default, ground, sensor, debris or all, joined with '|'.
+// Materials are declared before use; halfspaces are always static and
+// only take their colour from the material.
+
+struct FizziksScene {
+    struct Material {
+        char  name[24];
+        float mass, friction, radius;
+        Color color;
+    };
+    struct Body {
+        Vector2 position, velocity;
+        float   angle;                  // halfspaces, degrees
+        unsigned int category, mask;
+        unsigned short material;
+        unsigned char shape;            // CIRCLE or HALF_SPACE
+        unsigned char flags;            // BODY_STATIC | BODY_SENSOR
+    };
+    struct Name {
+        unsigned int body;              // index into bodies, ascending
+        char text[28];
+    };
+    struct Emitter {
+        Vector2 position;
+        float   rate, directionDeg, spreadDeg;
+        int     enabled;
+    };
+    enum { BODY_STATIC = 1, BODY_SENSOR = 2 };
+
+    Vector2   gravity{ 0, 300 };
+    float     timeStep = 1.0f / TARGET_FPS;
+    Rectangle bounds{ -300, -300, InitialWidth + 600, InitialHeight + 600 };
+    int       integrator = INTEGRATOR_SEMI_IMPLICIT_EULER;
+    std::vector<Material> materials;
+    std::vector<Body>     bodies;
+    std::vector<Name>     names;
+    std::vector<Emitter>  emitters;
+
+    bool load(const char* path) {
+        int size = 0;
+        unsigned char* data = FileExists(path) ? LoadFileData(path, &size) : nullptr;
+        if (!data) {
+            TraceLog(LOG_WARNING, "SCENE: [%s] Failed to open", path);
+            return false;
+        }
+        bool ok;
+        if (size >= 4 && memcmp(data, "FSCN", 4) == 0) ok = loadBinary(data, size, path);
+        else {
+            std::string text((const char*)data, (size_t)size);
+            ok = parse(text.c_str(), path);
+        }
+        UnloadFileData(data);
+        return ok;
+    }
+
+    bool parse(const char* text, const char* source = "text");
+    bool saveBinary(const char* path) const;
+
+    // Appends the bodies to w and sets its parameters; the first emitter,
+    // if any, configures emitter
+    void instantiate(FizziksWorld& w, FizziksEmitter* emitter = nullptr) const;
+
+private:
+    struct FileHeader {
+        char  magic[4];
+        int   version;
+        int   materialCount, bodyCount, nameCount, emitterCount;
+        Vector2   gravity;
+        float     timeStep;
+        Rectangle bounds;
+        int       integrator;
+    };
+
+    bool loadBinary(const unsigned char* data, int size, const char* path);
+    int  findMaterial(const char* name) const {
+        for (size_t i = 0; i < materials.size(); ++i)
+            if (strcmp(materials[i].name, name) == 0) return (int)i;
+        return -1;
+    }
+};
+
+static bool SceneColor(const char* const* tok, int n, int& i, Color& out)
+{
+    static const struct { const char* name; Color color; } named[] = {
+        { "lightgray", LIGHTGRAY }, { "gray", GRAY }, { "darkgray", DARKGRAY }, { "yellow", YELLOW },
+        { "gold", GOLD }, { "orange", ORANGE }, { "pink", PINK }, { "red", RED }, { "maroon", MAROON },
+        { "green", GREEN }, { "lime", LIME }, { "darkgreen", DARKGREEN }, { "skyblue", SKYBLUE },
+        { "blue", BLUE }, { "darkblue", DARKBLUE }, { "purple", PURPLE }, { "violet", VIOLET },
+        { "darkpurple", DARKPURPLE }, { "beige", BEIGE }, { "brown", BROWN }, { "darkbrown", DARKBROWN },
+        { "white", WHITE }, { "black", BLACK }, { "magenta", MAGENTA }, { "raywhite", RAYWHITE },
+    };
+    if (i >= n) return false;
+    for (const auto& c : named) {
+        if (strcmp(tok[i], c.name) == 0) { out = c.color; ++i; return true; }
+    }
+    if (i + 2 >= n) return false;
+    out = Color{ (unsigned char)atoi(tok[i]), (unsigned char)atoi(tok[i + 1]), (unsigned char)atoi(tok[i + 2]), 255 };
+    i += 3;
+    if (i < n && (tok[i][0] >= '0' && tok[i][0] <= '9')) out.a = (unsigned char)atoi(tok[i++]);
+    return true;
+}
+
+static bool SceneLayers(const char* text, unsigned int& out)
+{
+    out = 0;
+    while (*text) {
+        const char* end = strchr(text, '|');
+        size_t len = end ? (size_t)(end - text) : strlen(text);
+        if (len == 7 && strncmp(text, "default", len) == 0) out |= LAYER_DEFAULT;
+        else if (len == 6 && strncmp(text, "ground", len) == 0) out |= LAYER_GROUND;
+        else if (len == 6 && strncmp(text, "sensor", len) == 0) out |= LAYER_SENSOR;
+        else if (len == 6 && strncmp(text, "debris", len) == 0) out |= LAYER_DEBRIS;
+        else if (len == 3 && strncmp(text, "all", len) == 0) out |= LAYER_ALL;
+        else return false;
+        text += len + (end ? 1 : 0);
+    }
+    return true;
+}
+
+bool FizziksScene::parse(const char* text, const char* source)
+{
+    *this = FizziksScene();
+
+    char line[512];
+    const char* tok[64];
+    int lineNo = 0;
+    const char* p = text;
+    while (*p) {
+        const char* end = strchr(p, '\n');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        ++lineNo;
+        if (len >= sizeof(line)) {
+            TraceLog(LOG_WARNING, "SCENE: [%s:%d] Line too long", source, lineNo);
+            return false;
+        }
+        memcpy(line, p, len);
+        line[len] = 0;
+        p += len + (end ? 1 : 0);
+
+        // Split on whitespace, up to a comment
+        int n = 0;
+        for (char* c = line; *c && *c != '#' && n < 64;) {
+            while (*c == ' ' || *c == '\t' || *c == '\r') *c++ = 0;
+            if (!*c || *c == '#') break;
+            tok[n++] = c;
+            while (*c && *c != ' ' && *c != '\t' && *c != '\r' && *c != '#') ++c;
+            if (*c == '#') *c = 0;
+        }
+        if (n == 0) continue;
+
+        auto fail = [&](const char* what) {
+            TraceLog(LOG_WARNING, "SCENE: [%s:%d] %s", source, lineNo, what);
+            return false;
+        };
+        auto number = [&](int i) { return i < n ? strtof(tok[i], nullptr) : 0.0f; };
+
+        if (strcmp(tok[0], "world") == 0) {
+            for (int i = 1; i < n;) {
+                if (strcmp(tok[i], "gravity") == 0 && i + 2 < n) { gravity = Vector2{ number(i + 1), number(i + 2) }; i += 3; }
+                else if (strcmp(tok[i], "timestep") == 0 && i + 1 < n) { timeStep = number(i + 1); i += 2; }
+                else if (strcmp(tok[i], "bounds") == 0 && i + 4 < n) {
+                    bounds = Rectangle{ number(i + 1), number(i + 2), number(i + 3), number(i + 4) };
+                    i += 5;
+                }
+                else if (strcmp(tok[i], "integrator") == 0 && i + 1 < n) {
+                    static const char* modes[INTEGRATOR_COUNT] = { "euler", "semi-implicit", "verlet", "rk4" };
+                    integrator = -1;
+                    for (int m = 0; m < INTEGRATOR_COUNT; ++m) if (strcmp(tok[i + 1], modes[m]) == 0) integrator = m;
+                    if (integrator < 0) return fail("Unknown integrator");
+                    i += 2;
+                }
+                else return fail("Bad world parameter");
+            }
+        }
+        else if (strcmp(tok[0], "material") == 0) {
+            if (n < 2 || strlen(tok[1]) >= sizeof(Material::name)) return fail("Bad material name");
+            if (findMaterial(tok[1]) >= 0) return fail("Material declared twice");
+            Material m{};
+            strcpy(m.name, tok[1]);
+            m.mass = 1.0f; m.friction = 0.1f; m.radius = 18.0f; m.color = GREEN;
+            for (int i = 2; i < n;) {
+                if (strcmp(tok[i], "mass") == 0 && i + 1 < n) { m.mass = number(i + 1); i += 2; }
+                else if (strcmp(tok[i], "friction") == 0 && i + 1 < n) { m.friction = number(i + 1); i += 2; }
+                else if (strcmp(tok[i], "radius") == 0 && i + 1 < n) { m.radius = number(i + 1); i += 2; }
+                else if (strcmp(tok[i], "color") == 0) {
+                    ++i;
+                    if (!SceneColor(tok, n, i, m.color)) return fail("Bad color");
+                }
+                else return fail("Bad material parameter");
+            }
+            materials.push_back(m);
+        }
+        else if (strcmp(tok[0], "circle") == 0 || strcmp(tok[0], "halfspace") == 0) {
+            if (n < 4) return fail("Expected <material> x y");
+            int material = findMaterial(tok[1]);
+            if (material < 0) return fail("Unknown material");
+            Body b{};
+            b.position = Vector2{ number(2), number(3) };
+            b.material = (unsigned short)material;
+            b.category = LAYER_DEFAULT;
+            b.mask = LAYER_ALL;
+            b.shape = tok[0][0] == 'c' ? CIRCLE : HALF_SPACE;
+            if (b.shape == HALF_SPACE) b.flags = BODY_STATIC;
+            for (int i = 4; i < n;) {
+                if (strcmp(tok[i], "velocity") == 0 && i + 2 < n) { b.velocity = Vector2{ number(i + 1), number(i + 2) }; i += 3; }
+                else if (strcmp(tok[i], "angle") == 0 && i + 1 < n) { b.angle = number(i + 1); i += 2; }
+                else if (strcmp(tok[i], "static") == 0) { b.flags |= BODY_STATIC; ++i; }
+                else if (strcmp(tok[i], "sensor") == 0) { b.flags |= BODY_SENSOR; ++i; }
+                else if (strcmp(tok[i], "category") == 0 && i + 1 < n) {
+                    if (!SceneLayers(tok[i + 1], b.category)) return fail("Unknown layer");
+                    i += 2;
+                }
+                else if (strcmp(tok[i], "mask") == 0 && i + 1 < n) {
+                    if (!SceneLayers(tok[i + 1], b.mask)) return fail("Unknown layer");
+                    i += 2;
+                }
+                else if (strcmp(tok[i], "name") == 0 && i + 1 < n && strlen(tok[i + 1]) < sizeof(Name::text)) {
+                    Name name{};
+                    name.body = (unsigned int)bodies.size();
+                    strcpy(name.text, tok[i + 1]);
+                    names.push_back(name);
+                    i += 2;
+                }
+                else return fail("Bad body parameter");
+            }
+            bodies.push_back(b);
+        }
+        else if (strcmp(tok[0], "grid") == 0) {
+            if (n != 7) return fail("Expected grid <material> x y cols rows spacing");
+            int material = findMaterial(tok[1]);
+            if (material < 0) return fail("Unknown material");
+            int cols = atoi(tok[4]), rows = atoi(tok[5]);
+            float spacing = number(6);
+            Body b{};
+            b.material = (unsigned short)material;
+            b.category = LAYER_DEFAULT;
+            b.mask = LAYER_ALL;
+            b.shape = CIRCLE;
+            bodies.reserve(bodies.size() + (size_t)std::max(0, cols * rows));
+            for (int r = 0; r < rows; ++r)
+                for (int c = 0; c < cols; ++c) {
+                    b.position = Vector2{ number(2) + c * spacing, number(3) + r * spacing };
+                    bodies.push_back(b);
+                }
+        }
+        else if (strcmp(tok[0], "emitter") == 0) {
+            if (n < 3) return fail("Expected emitter x y");
+            Emitter e{ Vector2{ number(1), number(2) }, 2000.0f, -60.0f, 15.0f, 0 };
+            for (int i = 3; i < n;) {
+                if (strcmp(tok[i], "rate") == 0 && i + 1 < n) { e.rate = number(i + 1); i += 2; }
+                else if (strcmp(tok[i], "direction") == 0 && i + 1 < n) { e.directionDeg = number(i + 1); i += 2; }
+                else if (strcmp(tok[i], "spread") == 0 && i + 1 < n) { e.spreadDeg = number(i + 1); i += 2; }
+                else if (strcmp(tok[i], "on") == 0) { e.enabled = 1; ++i; }
+                else return fail("Bad emitter parameter");
+            }
+            emitters.push_back(e);
+        }
+        else return fail("Unknown entry");
+    }
+    return true;
+}
+
+bool FizziksScene::saveBinary(const char* path) const
+{
+    FileHeader header{ { 'F', 'S', 'C', 'N' }, 1, (int)materials.size(), (int)bodies.size(),
+        (int)names.size(), (int)emitters.size(), gravity, timeStep, bounds, integrator };
+    size_t size = sizeof(header) + materials.size() * sizeof(Material) + bodies.size() * sizeof(Body) +
+        names.size() * sizeof(Name) + emitters.size() * sizeof(Emitter);
+    std::vector<unsigned char> data(size);
+    unsigned char* out = data.data();
+    auto put = [&](const void* src, size_t bytes) { if (bytes) memcpy(out, src, bytes); out += bytes; };
+    put(&header, sizeof(header));
+    put(materials.data(), materials.size() * sizeof(Material));
+    put(bodies.data(), bodies.size() * sizeof(Body));
+    put(names.data(), names.size() * sizeof(Name));
+    put(emitters.data(), emitters.size() * sizeof(Emitter));
+    return SaveFileData(path, data.data(), (int)data.size());
+}
+
+bool FizziksScene::loadBinary(const unsigned char* data, int size, const char* path)
+{
+    FileHeader header;
+    bool ok = size >= (int)sizeof(header);
+    if (ok) {
+        memcpy(&header, data, sizeof(header));
+        ok = header.version == 1 && header.materialCount >= 0 && header.bodyCount >= 0 &&
+            header.nameCount >= 0 && header.emitterCount >= 0 &&
+            (size_t)size == sizeof(header) + header.materialCount * sizeof(Material) +
+            (size_t)header.bodyCount * sizeof(Body) + header.nameCount * sizeof(Name) +
+            header.emitterCount * sizeof(Emitter);
+    }
+    if (!ok) {
+        TraceLog(LOG_WARNING, "SCENE: [%s] Not a version 1 scene file", path);
+        return false;
+    }
+
+    gravity = header.gravity;
+    timeStep = header.timeStep;
+    bounds = header.bounds;
+    integrator = header.integrator;
+    const unsigned char* in = data + sizeof(header);
+    auto take = [&](auto& v, int count) {
+        v.resize(count);
+        if (count) memcpy(v.data(), in, count * sizeof(v[0]));
+        in += count * sizeof(v[0]);
+    };
+    take(materials, header.materialCount);
+    take(bodies, header.bodyCount);
+    take(names, header.nameCount);
+    take(emitters, header.emitterCount);
+
+    // The file is not trusted: strings may lack their terminator, indices
+    // may be out of range, and instantiate() walks names in body order
+    for (Material& m : materials) m.name[sizeof(m.name) - 1] = '\0';
+    for (Name& nm : names) nm.text[sizeof(nm.text) - 1] = '\0';
+    for (const Body& b : bodies) {
+        if (b.material >= materials.size()) {
+            TraceLog(LOG_WARNING, "SCENE: [%s] Body with a bad material", path);
+            return false;
+        }
+    }
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (names[i].body >= bodies.size() || (i > 0 && names[i].body <= names[i - 1].body)) {
+            TraceLog(LOG_WARNING, "SCENE: [%s] Name table out of range or not in body order", path);
+            return false;
+        }
+    }
+    return true;
+}
+
+void FizziksScene::instantiate(FizziksWorld& w, FizziksEmitter* emitter) const
+{
+    w.accelerationGravity = gravity;
+    w.timeStep = timeStep;
+    w.bounds = bounds;
+    w.integrator = (FizziksIntegrator)integrator;
+
+    w.reserve(bodies.size());
+    size_t nextName = 0;
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        const Body& b = bodies[i];
+        const Material& m = materials[b.material];
+        FizziksObjekt* o;
+        if (b.shape == HALF_SPACE) {
+            auto* h = new FizziksHalfspace();
+            h->setRotationDegrees(b.angle);
+            o = h;
+        }
+        else {
+            auto* c = new FizziksCircle();
+            c->radius = m.radius;
+            c->kFriction = m.friction;
+            o = c;
+        }
+        o->position = b.position;
+        o->velocity = b.velocity;
+        o->mass = m.mass;
+        o->baseColor = o->color = m.color;
+        o->category = b.category;
+        o->mask = b.mask;
+        o->isStatic = (b.flags & BODY_STATIC) != 0;
+        o->isSensor = (b.flags & BODY_SENSOR) != 0;
+        w.add(o);
+        if (nextName < names.size() && names[nextName].body == i) o->name = names[nextName++].text;
+    }
+
+    if (emitter && !emitters.empty()) {
+        const Emitter& e = emitters[0];
+        emitter->position = e.position;
+        emitter->rate = e.rate;
+        emitter->directionDeg = e.directionDeg;
+        emitter->spreadDeg = e.spreadDeg;
+        emitter->enabled = e.enabled != 0;
+    }
+}
+
+//   Boxes and polygons: a static ledge, a box and a triangle that land on it
+
+static FizziksPolygon* gLedge = nullptr;
+static FizziksTerrain* gTerrain = nullptr;
+
+static void SpawnPolygons()
+{
+    {
+        auto* ledge = new FizziksPolygon();
+        ledge->position = { 950, 520 };
+        ledge->setBox(260.0f, 24.0f);
+        ledge->baseColor = GRAY; ledge->color = GRAY;
+        ledge->makeStatic(true);
+        world.add(ledge);
+        gLedge = ledge;
+    }
+    {
+        auto* box = new FizziksPolygon();
+        box->position = { 900, 300 };
+        box->setBox(50.0f, 50.0f);
+        box->mass = 4.0f;
+        box->baseColor = ORANGE; box->color = ORANGE;
+        world.add(box);
+    }
+    {
+        auto* tri = new FizziksPolygon();
+        const Vector2 v[3] = { { 0, -30 }, { 30, 20 }, { -30, 20 } };
+        tri->position = { 1000, 220 };
+        tri->setVertices(v, 3);
+        tri->baseColor = PURPLE; tri->color = PURPLE;
+        world.add(tri);
+    }
+}
+
+//   Terrain: rolling hills left of the ground, with a few balls to roll on them
+
+static void SpawnTerrain()
+{
+    const int segments = 2000;
+    std::vector<Vector2> hills(segments + 1);
+    for (int i = 0; i <= segments; ++i) {
+        float x = -280.0f + 560.0f * i / segments;
+        hills[i] = Vector2{ x, 460.0f + 40.0f * sinf(x / 45.0f) + 8.0f * sinf(x / 6.0f) };
+    }
+    auto* t = new FizziksTerrain();
+    t->setPoints(hills.data(), (int)hills.size());
+    t->baseColor = BROWN; t->color = BROWN;
+    t->category = LAYER_GROUND;
+    world.add(t);
+    gTerrain = t;
+
+    for (int i = 0; i < 8; ++i) {
+        auto* c = new FizziksCircle();
+        c->position = { -250.0f + 60.0f * i, 300.0f };
+        c->radius = 10.0f;
+        c->baseColor = LIME; c->color = LIME;
+        world.add(c);
+    }
+}
+
+//   Frame phases around the simulation thread
+
+// After a step: zone count from its events, then the main-thread effects
+static void afterStep()
+{
+    for (const FizziksTriggerEvent& e : world.getEvents()) {
+        if (e.a != gZone->id && e.b != gZone->id) continue;
+        if (e.type == TRIGGER_ENTER) ++gInZone;
+        if (e.type == TRIGGER_EXIT) --gInZone;
+    }
+
+    gEmitter.update(world.timeStep, world.accelerationGravity, world.getHalfspaces());
+    if (gTrails.enabled) gTrails.record(world.objekts);
+}
+
+// Scrubbing replaces the whole world state, so unlike the slider commands it
+// waits for the sync point of the frame, while the world is idle (as does
+// the neighbour list switch)
+// The world decides the slider values again, after a restore or a replay
+static void syncUiFromWorld()
+{
+    if (gGround) groundAngleDeg = gUi.sentGroundAngle = gGround->getRotation();
+    gUi.gravityY = world.accelerationGravity.y;
+    gUi.integrator = world.integrator;
+}
+
+static void applyUi()
+{
+    world.useNeighbourList = gUi.neighbourList;
+    world.reorderBodies = gUi.reorderBodies;
+    if (gUi.scrub) {
+        gUi.scrub = false;
+        world.scrubTo(gUi.scrubTime);
+        syncUiFromWorld();
+        gTrails.clear();                // they show the history we left
+    }
+}
+
+static void updateHover()
+{
+    FizziksObjekt* picked[8];
+    int nPicked = world.queryPoint(GetScreenToWorld2D(GetMousePosition(), gCamera), picked, 8);
+    gUi.hover[0] = 0;
+    gUi.hoverId = -1;
+    for (int i = 0; i < nPicked; ++i) {
+        FizziksShape shape = picked[i]->Shape();
+        if (picked[i]->isStatic || (shape != CIRCLE && shape != POLYGON)) continue;
+        if (picked[i]->name.empty()) snprintf(gUi.hover, sizeof(gUi.hover), "#%u", picked[i]->id);
+        else snprintf(gUi.hover, sizeof(gUi.hover), "%s", picked[i]->name.c_str());
+        gUi.hoverId = (int)picked[i]->id;
+        break;
+    }
+}
+
+// Runs on gSimThread
+static void StepIntoBackSnapshot()
+{
+    world.update();
+    world.writeSnapshot(gSnapshots[1 - gFront]);
+}
+
+// Lab 6 as shipped in game/scenes/lab6.txt, for when that file cannot be
+// found (the game was started from somewhere else)
+static const char* LAB6_SCENE = R"(
+world gravity 0 300 timestep 0.0166667 bounds -300 -300 1880 1320 integrator semi-implicit
+material ground  color gray
+material zone    radius 90 color darkblue
+material red     mass 2 friction 0.1 radius 18 color red
+material green   mass 2 friction 0.8 radius 18 color green
+material blue    mass 8 friction 0.1 radius 18 color blue
+material yellow  mass 8 friction 0.8 radius 18 color yellow
+halfspace ground 640 540 angle 0 category ground name ground
+circle zone 500 420 static sensor category sensor mask default name zone
+circle red     350 200
+circle green   450 200
+circle blue    550 200
+circle yellow  650 200
+emitter 150 450 rate 2000 direction -60 spread 15
+)";
+
+// Loads scenes/<file> from next to the executable, from the source tree
+// when the executable is in bin/<config>/, or from the working directory
+// (the solution or the game directory); else parses fallback
+static bool LoadScene(FizziksScene& scene, const char* file, const char* fallback)
+{
+    std::string app = GetApplicationDirectory();
+    const std::string candidates[] = {
+        app + "scenes/" + file,
+        app + "../../game/scenes/" + file,
+        std::string("game/scenes/") + file,
+        std::string("scenes/") + file,
+    };
+    for (const std::string& path : candidates)
+        if (FileExists(path.c_str())) return scene.load(path.c_str());
+    TraceLog(LOG_WARNING, "SCENE: %s not found, using the built-in copy", file);
+    return scene.parse(fallback, file);
+}
+
+static FizziksObjekt* FindNamed(const char* name, FizziksShape shape)
+{
+    for (auto* o : world.objekts)
+        if (o->Shape() == shape && o->name == name) return o;
+    return nullptr;
+}
+
+//   Per-frame draw
+
+//   Camera controls: right-drag to pan, wheel to zoom at the cursor, HOME to reset
+
+static void updateCamera()
+{
+    if (IsMouseButtonDown(MOUSE_BUTTON_RIGHT)) {
+        Vector2 delta = Vector2Scale(GetMouseDelta(), -1.0f / gCamera.zoom);
+        gCamera.target = Vector2Add(gCamera.target, delta);
+    }
+
+    float wheel = GetMouseWheelMove();
+    if (wheel != 0.0f) {
+        // Keep the world point under the cursor fixed while zooming
+        Vector2 mouse = GetMousePosition();
+        gCamera.target = GetScreenToWorld2D(mouse, gCamera);
+        gCamera.offset = mouse;
+        gCamera.zoom = Clamp(gCamera.zoom * expf(0.1f * wheel), 0.02f, 20.0f);
+    }
+
+    if (IsKeyPressed(KEY_HOME)) gCamera = Camera2D{ { 0, 0 }, { 0, 0 }, 0.0f, 1.0f };
+}
+
+// Current / peak bytes per memory tag, top right; red when over budget
+static void drawMemoryPanel()
+{
+    const float width = 330.0f;
+    Rectangle panel{ GetScreenWidth() - width - 10.0f, 10.0f, width, 34.0f + 18.0f * (MEM_TAG_COUNT + 1) };
+    GuiGroupBox(panel, "Memory (MB)");
+    int x = (int)panel.x + 10, y = (int)panel.y + 14;
+    DrawText("tag", x, y, 16, DARKGRAY);
+    DrawText("current", x + 120, y, 16, DARKGRAY);
+    DrawText("peak", x + 220, y, 16, DARKGRAY);
+    for (int t = 0; t < MEM_TAG_COUNT; ++t) {
+        FizziksMemTag tag = (FizziksMemTag)t;
+        y += 18;
+        Color color = FizziksMemory::overBudget(tag) ? RED : GRAY;
+        DrawText(FizziksMemory::name(tag), x, y, 16, color);
+        DrawText(TextFormat("%.2f", FizziksMemory::currentBytes(tag) / (1024.0 * 1024.0)), x + 120, y, 16, color);
+        DrawText(TextFormat("%.2f", FizziksMemory::peakBytes(tag) / (1024.0 * 1024.0)), x + 220, y, 16, color);
+    }
+    y += 18;
+    DrawText("total", x, y, 16, LIGHTGRAY);
+    DrawText(TextFormat("%.2f", FizziksMemory::totalBytes() / (1024.0 * 1024.0)), x + 120, y, 16, LIGHTGRAY);
+}
+
+// Reads only the front snapshot and main-thread state: the world may be
+// stepping on gSimThread meanwhile
+static void drawFrame()
+{
+    auto start = std::chrono::steady_clock::now();
+    BeginDrawing();
+    ClearBackground(BLACK);
+
+    BeginMode2D(gCamera);
+    {
+        Vector2 viewMin = GetScreenToWorld2D(Vector2{ 0, 0 }, gCamera);
+        Vector2 viewMax = GetScreenToWorld2D(Vector2{ (float)GetScreenWidth(), (float)GetScreenHeight() }, gCamera);
+        gEmitter.draw(Rectangle{ viewMin.x, viewMin.y, viewMax.x - viewMin.x, viewMax.y - viewMin.y }, 1.0f / gCamera.zoom);
+    }
+    gTrails.draw();
+    FizziksRenderSnapshot& snap = gSnapshots[gFront];
+    snap.draw(gCamera);
+    if (gEmitter.enabled) DrawCircleLinesV(gEmitter.position, 8.0f / gCamera.zoom, SKYBLUE);
+    EndMode2D();
+
+    // Header/footer
+    DrawText("Aathiththan Yogeswaran 101462564", 10, GetScreenHeight() - 26, 20, LIGHTGRAY);
+    DrawText(TextFormat("Objects: %i", snap.objektCount), 10, 10, 20, LIGHTGRAY);
+
+    // GUI – sliders (same look as previous labs)
+    // Slider changes reach the world as commands, applied at its next step
+    // The angle goes out only when it differs from the last one sent, so
+    // holding the slider does not fill the queue and the command log
+    GuiSliderBar(Rectangle{ 10, 40, 500, 26 }, "Ground angle",
+        TextFormat("%.1f deg", groundAngleDeg), &groundAngleDeg, -45.0f, 45.0f);
+    if (gGround && groundAngleDeg != gUi.sentGroundAngle &&
+        world.commands.push(FizziksCommand::SetRotation(gGround->id, groundAngleDeg)))
+        gUi.sentGroundAngle = groundAngleDeg;
+
+    if (GuiSliderBar(Rectangle{ 10, 72, 500, 26 }, "GravityY",
+        TextFormat("%.0f", gUi.gravityY),
+        &gUi.gravityY, 0.0f, 1000.0f))
+        world.commands.push(FizziksCommand::SetGravity(Vector2{ 0, gUi.gravityY }));
+
+    // Color legend
+    DrawText("Vectors: RED = velocity, PURPLE = gravity, GREEN = normal, ORANGE = friction",
+        10, 110, 18, LIGHTGRAY);
+
+    // Debug vector toggles
+    GuiCheckBox(Rectangle{ 10, 136, 16, 16 }, "velocity", &gDebugDraw.enabled[DEBUG_VELOCITY]);
+    GuiCheckBox(Rectangle{ 110, 136, 16, 16 }, "gravity", &gDebugDraw.enabled[DEBUG_GRAVITY]);
+    GuiCheckBox(Rectangle{ 200, 136, 16, 16 }, "normal", &gDebugDraw.enabled[DEBUG_NORMAL]);
+    GuiCheckBox(Rectangle{ 290, 136, 16, 16 }, "friction", &gDebugDraw.enabled[DEBUG_FRICTION]);
+    GuiSliderBar(Rectangle{ 480, 136, 150, 16 }, "min length",
+        TextFormat("%.0f px", gDebugDraw.minLength), &gDebugDraw.minLength, 0.0f, 50.0f);
+    DrawText(TextFormat("Zoom: %.2fx  (right-drag = pan, wheel = zoom, HOME = reset, N/X = add/remove sphere)", gCamera.zoom),
+        10, 160, 18, GRAY);
+
+    // Point query: which bodies are under the mouse (see updateHover)
+    if (gUi.hover[0])
+        DrawText(TextFormat("Under mouse: %s", gUi.hover), 10, 184, 18, GRAY);
+    DrawText(TextFormat("In trigger zone: %i", gInZone), 10, 208, 18, GRAY);
+
+    // Integrator choice + drift since the last baseline
+    int integ = gUi.integrator;
+    GuiToggleGroup(Rectangle{ 10, 236, 110, 22 }, "Euler;Semi-implicit;Verlet;RK4", &gUi.integrator);
+    if (gUi.integrator != integ) world.commands.push(FizziksCommand::SetIntegrator((FizziksIntegrator)gUi.integrator));
+    DrawText(TextFormat("Energy drift: %+.3f%%   momentum drift: %.2f px/s   (%i steps)",
+        snap.drift.energyDrift * 100.0, snap.drift.momentumDrift, snap.drift.steps), 10, 264, 18, GRAY);
+
+    // Timeline: dragging rewinds/replays the world from its checkpoints
+    GuiCheckBox(Rectangle{ 10, 294, 16, 16 }, "pause (P)", &gPaused);
+    float scrub = gUi.scrub ? gUi.scrubTime : snap.time;
+    if (GuiSliderBar(Rectangle{ 160, 290, 500, 22 }, "Time",
+        TextFormat("%.2f / %.2f s", snap.time, snap.lastTime), &scrub, 0.0f, snap.lastTime)) {
+        gUi.scrub = true;
+        gUi.scrubTime = scrub;
+    }
+    DrawText(TextFormat("Checkpoints: %i every %i steps, %.1f MB%s", snap.checkpointCount,
+        snap.checkpointInterval, snap.checkpointBytes / (1024.0 * 1024.0),
+        snap.scrubbing ? "   (re-simulating...)" : ""), 10, 318, 18, GRAY);
+
+    // Particle emitter
+    GuiCheckBox(Rectangle{ 10, 346, 16, 16 }, "emitter (E)", &gEmitter.enabled);
+    GuiSliderBar(Rectangle{ 200, 342, 300, 22 }, "Rate",
+        TextFormat("%.0f /s", gEmitter.rate), &gEmitter.rate, 0.0f, 20000.0f);
+    DrawText(TextFormat("Particles: %i / %i  (middle-click = move emitter)", gEmitter.alive(), gEmitter.capacity()),
+        10, 370, 18, GRAY);
+
+    // Trails
+    GuiCheckBox(Rectangle{ 10, 398, 16, 16 }, "trails", &gTrails.enabled);
+    DrawText(TextFormat("%i vertices for %lld samples", gTrails.vertexCount(), gTrails.sampleCount()),
+        110, 398, 18, GRAY);
+
+    if (world.sdf.ready())
+        DrawText(TextFormat("SDF: %i x %i samples, %s in %.0f ms", world.sdf.cols, world.sdf.rows,
+            world.sdf.fromCache ? "loaded" : "baked", world.sdf.bakeSeconds * 1e3), 10, 422, 18, GRAY);
+
+    // Pipelining
+    GuiCheckBox(Rectangle{ 10, 450, 16, 16 }, "pipelined (T)", &gPipelined);
+    DrawText(TextFormat("step %.2f ms, draw %.2f ms", snap.stepSeconds * 1e3, gDrawSeconds * 1e3),
+        160, 450, 18, GRAY);
+    DrawText(TextFormat("Frame arena: peak %.1f KB of %.1f KB, %i chunk allocations", snap.arenaPeak / 1024.0,
+        snap.arenaCapacity / 1024.0, snap.arenaAllocations), 10, 474, 18, GRAY);
+
+    // Neighbour list
+    GuiCheckBox(Rectangle{ 10, 502, 16, 16 }, "neighbour list", &gUi.neighbourList);
+    if (snap.neighbourList)
+        DrawText(TextFormat("%i pairs, rebuilt on %.0f%% of steps", snap.neighbourPairs,
+            snap.neighbourRebuildRate * 100.0f), 160, 502, 18, GRAY);
+
+    // Body order
+    GuiCheckBox(Rectangle{ 10, 530, 16, 16 }, "z-order bodies", &gUi.reorderBodies);
+    DrawText(TextFormat("pair distance %.0f, %lld sorts (last %.1f ms)", snap.locality.pairDistance,
+        snap.locality.sorts, snap.locality.sortSeconds * 1e3), 160, 530, 18, GRAY);
+
+    drawMemoryPanel();
+
+    gDrawSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    EndDrawing();
+}
+
+//   Benchmarks (headless, run with --bench)
+
+using BenchClock = std::chrono::steady_clock;
+
+static double BenchSeconds(BenchClock::time_point since)
+{
+    return std::chrono::duration<double>(BenchClock::now() - since).count();
+}
+
+// Fills w with n random circles in a square domain sized for ~20x20 px of
+// space per body, plus one ground halfspace
+static void BenchPopulate(FizziksWorld& w, int n, std::mt19937& rng)
+{
+    float side = sqrtf((float)n) * 20.0f;
+    w.bounds = Rectangle{ 0, 0, side, side };
+
+    std::uniform_real_distribution<float> pos(0.0f, side);
+    std::uniform_real_distribution<float> rad(2.0f, 8.0f);
+    w.objekts.reserve(n + 1);
+    for (int i = 0; i < n; ++i) {
+        auto* c = new FizziksCircle();
+        c->position = Vector2{ pos(rng), pos(rng) };
+        c->radius = rad(rng);
+        w.add(c);
+    }
+
+    auto* g = new FizziksHalfspace();
+    g->position = Vector2{ 0, side };
+    g->makeStatic(true);
+    w.add(g);
+}
+
+static void BenchSpatialQueries(int n)
+{
+    std::mt19937 rng(2005);
+    FizziksWorld w;
+    BenchPopulate(w, n, rng);
+    float side = w.bounds.width;
+
+    auto t0 = BenchClock::now();
+    w.rebuildGrid();
+    double build = BenchSeconds(t0);
+
+    std::uniform_real_distribution<float> pos(0.0f, side);
+    std::uniform_real_distribution<float> ang(0.0f, 2.0f * PI);
+    FizziksObjekt* out[256];
+    long long found = 0;
+
+    const int rays = 100000;
+    FizziksRayHit hit;
+    t0 = BenchClock::now();
+    for (int i = 0; i < rays; ++i) {
+        float a = ang(rng);
+        if (w.raycast(Vector2{ pos(rng), pos(rng) }, Vector2{ cosf(a), sinf(a) }, 2000.0f, hit)) ++found;
+    }
+    double tRay = BenchSeconds(t0);
+
+    const int points = 1000000;
+    t0 = BenchClock::now();
+    for (int i = 0; i < points; ++i) found += w.queryPoint(Vector2{ pos(rng), pos(rng) }, out, 256);
+    double tPoint = BenchSeconds(t0);
+
+    const int boxes = 100000;
+    t0 = BenchClock::now();
+    for (int i = 0; i < boxes; ++i) {
+        Vector2 mn{ pos(rng), pos(rng) };
+        found += w.queryAABB(mn, Vector2{ mn.x + 100.0f, mn.y + 100.0f }, out, 256);
+    }
+    double tBox = BenchSeconds(t0);
+
+    t0 = BenchClock::now();
+    for (int i = 0; i < boxes; ++i) found += w.queryCircle(Vector2{ pos(rng), pos(rng) }, 50.0f, out, 256);
+    double tCircle = BenchSeconds(t0);
+
+    printf("spatial queries, %d bodies (grid build %.1f ms)\n", n, build * 1e3);
+    printf("  raycast     %8.0f ns/query\n", tRay / rays * 1e9);
+    printf("  point       %8.0f ns/query\n", tPoint / points * 1e9);
+    printf("  aabb 100px  %8.0f ns/query\n", tBox / boxes * 1e9);
+    printf("  circle r50  %8.0f ns/query\n", tCircle / boxes * 1e9);
+    printf("  (%lld results)\n", found);
+}
+
+// Dense particle scene, once with default layers and once as debris that
+// only collides with the ground
+static void BenchLayerFilter(int n)
+{
+    for (int pass = 0; pass < 2; ++pass) {
+        std::mt19937 rng(2005);
+        FizziksWorld w;
+        BenchPopulate(w, n, rng);
+        for (auto* o : w.objekts) {
+            if (o->Shape() == HALF_SPACE) o->category = LAYER_GROUND;
+            else if (pass == 1) { o->category = LAYER_DEBRIS; o->mask = LAYER_GROUND; }
+        }
+
+        const int steps = 10;
+        auto t0 = BenchClock::now();
+        for (int i = 0; i < steps; ++i) w.checkCollisions();
+        printf("checkCollisions, %d bodies, %-13s %8.2f ms/step\n", n,
+            pass == 0 ? "all layers:" : "debris only:", BenchSeconds(t0) / steps * 1e3);
+    }
+}
+
+// Free flight, no contacts: energy drift of each integrator over 10 s at a
+// few step sizes, plus cost per body-step
+static void BenchIntegrators(int n)
+{
+    static const char* names[INTEGRATOR_COUNT] = { "euler", "semi-implicit", "verlet", "rk4" };
+    const float steps[3] = { 1.0f / 120.0f, 1.0f / 60.0f, 1.0f / 15.0f };
+
+    for (int k = 0; k < INTEGRATOR_COUNT; ++k) {
+        printf("integrator %-13s", names[k]);
+        for (float h : steps) {
+            std::mt19937 rng(2005);
+            FizziksWorld w;
+            BenchPopulate(w, n, rng);
+            w.integrator = (FizziksIntegrator)k;
+            std::uniform_real_distribution<float> vel(-300.0f, 300.0f);
+            for (auto* o : w.objekts) o->velocity = Vector2{ vel(rng), vel(rng) };
+
+            int count = (int)(10.0f / h);
+            w.sampleDrift();
+            auto t0 = BenchClock::now();
+            for (int i = 0; i < count; ++i) w.integrate(h);
+            double t = BenchSeconds(t0);
+            w.sampleDrift();
+            printf("  dt=1/%-3.0f drift %+9.2e (%5.1f ns/body)", 1.0f / h, w.drift.energyDrift, t / count / n * 1e9);
+        }
+        printf("\n");
+    }
+}
+
+// Record a run with some input, then rewind into it: restore cost, snapshot
+// size and whether the replayed state matches the original bit for bit
+static void BenchScrub(int n)
+{
+    std::mt19937 rng(2005);
+    FizziksWorld w;
+    BenchPopulate(w, n, rng);
+
+    // The input goes in between checkpoints 30 and 60, so rewinding to
+    // step 45 has to replay it from the command log
+    const int steps = 120, target = 45;
+    std::vector<Vector2> before;
+    auto t0 = BenchClock::now();
+    for (int i = 0; i < steps; ++i) {
+        if (i == 35) {
+            auto* c = new FizziksCircle();
+            c->position = Vector2{ w.bounds.width * 0.5f, w.bounds.height * 0.25f };
+            c->velocity = Vector2{ 40, 0 };
+            c->radius = 6.0f;
+            w.commands.push(FizziksCommand::Add(c));
+        }
+        if (i == 38) w.commands.push(FizziksCommand::SetGravity(Vector2{ 50, 200 }));
+        if (i == 42) w.commands.push(FizziksCommand::Remove(5));
+        w.update();
+        if (w.getStep() == target)
+            for (auto* o : w.objekts) before.push_back(o->position);
+    }
+    double tStep = BenchSeconds(t0) / steps;
+
+    t0 = BenchClock::now();
+    w.scrubTo(target * w.timeStep);             // back to checkpoint 30
+    double tRestore = BenchSeconds(t0);
+    long long from = w.getStep();
+    w.continueScrub(1e9);
+
+    float maxErr = before.size() == w.objekts.size() ? 0.0f : INFINITY;
+    for (size_t i = 0; i < before.size() && i < w.objekts.size(); ++i)
+        maxErr = std::max(maxErr, Vector2Distance(before[i], w.objekts[i]->position));
+    printf("scrub, %d bodies: step %.2f ms, restore %.2f ms (from step %lld), %i checkpoints %.1f MB, replay error %g px\n",
+        n, tStep * 1e3, tRestore * 1e3, from, w.checkpointCount(), w.checkpointBytes() / (1024.0 * 1024.0), maxErr);
+}
+
+// Emitter at 20k particles/s: steady state is rate * lifetime live particles
+static void BenchEmitter(int capacity)
+{
+    FizziksVector<FizziksHalfspace*, MEM_BROADPHASE> planes;
+    FizziksHalfspace ground;
+    ground.position = Vector2{ 0, 600 };
+    planes.push_back(&ground);
+
+    FizziksEmitter e;
+    e.init(capacity);
+    e.enabled = true;
+    e.rate = 20000.0f;
+    const float h = 1.0f / TARGET_FPS;
+    for (int i = 0; i < 300; ++i) e.update(h, Vector2{ 0, 300 }, planes);
+
+    const int steps = 120;
+    auto t0 = BenchClock::now();
+    for (int i = 0; i < steps; ++i) e.update(h, Vector2{ 0, 300 }, planes);
+    double t = BenchSeconds(t0) / steps;
+    printf("emitter, %d live particles: %.3f ms/step (%.1f ns/particle)\n", e.alive(), t * 1e3, t / e.alive() * 1e9);
+}
+
+// Ballistic flight (integrate only, no contacts): recording cost and how
+// many vertices the decimation keeps
+static void BenchTrails(int n)
+{
+    std::mt19937 rng(2005);
+    FizziksWorld w;
+    BenchPopulate(w, n, rng);
+    std::uniform_real_distribution<float> vel(-300.0f, 300.0f);
+    for (auto* o : w.objekts) o->velocity = Vector2{ vel(rng), vel(rng) };
+
+    FizziksTrailRecorder trails;
+    trails.init(256, 32);
+    const int steps = 600;
+    double t = 0.0;
+    for (int i = 0; i < steps; ++i) {
+        w.integrate(w.timeStep);
+        auto t0 = BenchClock::now();
+        trails.record(w.objekts);
+        t += BenchSeconds(t0);
+    }
+    printf("trails, %d bodies x %d steps: %.1f ns/sample, %d vertices for %lld samples (%.2f%%)\n",
+        n, steps, t / trails.sampleCount() * 1e9, trails.vertexCount(), trails.sampleCount(),
+        100.0 * trails.vertexCount() / trails.sampleCount());
+}
+
+// Randomly turned boxes and hexagons, ~30x30 px of space each. The SAT tests are
+// timed on their own over every AABB-overlapping pair: once from scratch,
+// once starting from the axis the previous pass found, after every body
+// moved a little (what the next step sees).
+static void BenchPolygons(int n)
+{
+    std::mt19937 rng(2005);
+    float side = sqrtf((float)n) * 30.0f;
+    std::uniform_real_distribution<float> pos(0.0f, side);
+    std::uniform_real_distribution<float> size(4.0f, 14.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 2.0f * PI);
+    std::vector<FizziksPolygon> polys(n);
+    for (int i = 0; i < n; ++i) {
+        FizziksPolygon& p = polys[i];
+        p.position = Vector2{ pos(rng), pos(rng) };
+        Vector2 v[6];
+        int count = i % 2 == 0 ? 4 : 6;
+        if (count == 4) {
+            float hw = size(rng) * 0.5f, hh = size(rng) * 0.5f;
+            v[0] = { -hw, -hh }; v[1] = { hw, -hh }; v[2] = { hw, hh }; v[3] = { -hw, hh };
+        }
+        else {
+            float r = size(rng) * 0.5f;
+            for (int k = 0; k < 6; ++k) v[k] = Vector2{ r * cosf(k * PI / 3.0f), r * sinf(k * PI / 3.0f) };
+        }
+        float turn = angle(rng);
+        for (int k = 0; k < count; ++k) v[k] = Vector2Rotate(v[k], turn);
+        p.setVertices(v, count);
+        p.updateBounds();
+    }
+
+    // Candidate pairs: sweep along x
+    std::vector<int> order(n);
+    for (int i = 0; i < n; ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return polys[a].boundsMin.x < polys[b].boundsMin.x; });
+    std::vector<std::pair<int, int>> pairs;
+    for (int i = 0; i < n; ++i) {
+        const FizziksPolygon& A = polys[order[i]];
+        for (int j = i + 1; j < n && polys[order[j]].boundsMin.x <= A.boundsMax.x; ++j) {
+            const FizziksPolygon& B = polys[order[j]];
+            if (A.boundsMax.y < B.boundsMin.y || B.boundsMax.y < A.boundsMin.y) continue;
+            pairs.push_back({ order[i], order[j] });
+        }
+    }
+
+    std::vector<int> axes(pairs.size(), -1);
+    FizziksManifold m;
+    bool cacheHit;
+    for (int pass = 0; pass < 2; ++pass) {
+        int hits = 0, rejects = 0;
+        auto t0 = BenchClock::now();
+        for (size_t k = 0; k < pairs.size(); ++k) {
+            if (pass == 0) axes[k] = -1;
+            hits += CollidePolygons(&polys[pairs[k].first], &polys[pairs[k].second], axes[k], cacheHit, m);
+            rejects += cacheHit;
+        }
+        double t = BenchSeconds(t0);
+        printf("polygon SAT, %zu pairs, %-10s %6.1f ns/pair, %d overlapping, %.0f%% settled by the cached axis\n",
+            pairs.size(), pass == 0 ? "no cache:" : "cached:", t / pairs.size() * 1e9, hits,
+            100.0 * rejects / pairs.size());
+
+        std::uniform_real_distribution<float> jitter(-0.5f, 0.5f);
+        for (FizziksPolygon& p : polys) p.position = Vector2Add(p.position, Vector2{ jitter(rng), jitter(rng) });
+    }
+}
+
+// Same world with and without a 10k-segment terrain across it: the
+// difference is what the terrain costs per body
+static void BenchTerrain(int n, int segments)
+{
+    double perStep[2];
+    for (int pass = 0; pass < 2; ++pass) {
+        std::mt19937 rng(2005);
+        FizziksWorld w;
+        BenchPopulate(w, n, rng);
+        if (pass == 1) {
+            float side = w.bounds.width;
+            std::vector<Vector2> hills(segments + 1);
+            for (int i = 0; i <= segments; ++i) {
+                float x = side * i / segments;
+                hills[i] = Vector2{ x, side * 0.5f + 60.0f * sinf(x / 80.0f) };
+            }
+            auto* t = new FizziksTerrain();
+            t->setPoints(hills.data(), (int)hills.size());
+            w.add(t);
+        }
+
+        const int steps = 10;
+        w.checkCollisions();
+        auto t0 = BenchClock::now();
+        for (int i = 0; i < steps; ++i) w.checkCollisions();
+        perStep[pass] = BenchSeconds(t0) / steps;
+    }
+    printf("terrain, %d bodies: %.2f ms/step without, %.2f ms/step with %d segments (%+.1f ns/body)\n",
+        n, perStep[0] * 1e3, perStep[1] * 1e3, segments, (perStep[1] - perStep[0]) / n * 1e9);
+}
+
+// Bake a 10k-segment terrain plus some ledges at 2 px, load it back from
+// the cache, and compare a lookup with walking the terrain BVH
+static void BenchSdf()
+{
+    const float side = 2000.0f;
+    std::vector<Vector2> hills(10001);
+    for (int i = 0; i <= 10000; ++i) {
+        float x = side * i / 10000;
+        hills[i] = Vector2{ x, side * 0.6f + 80.0f * sinf(x / 90.0f) + 10.0f * sinf(x / 7.0f) };
+    }
+    FizziksTerrain terrain;
+    terrain.setPoints(hills.data(), (int)hills.size());
+    std::vector<FizziksPolygon> ledges(20);
+    for (int i = 0; i < 20; ++i) {
+        ledges[i].position = Vector2{ 50.0f + i * 100.0f, side * 0.3f };
+        ledges[i].setBox(80.0f, 16.0f);
+        ledges[i].updateBounds();
+    }
+    std::vector<FizziksObjekt*> statics{ &terrain };
+    for (auto& l : ledges) statics.push_back(&l);
+
+    FizziksSdf sdf;
+    Rectangle area{ 0, 0, side, side };
+    sdf.bake(statics, area, 2.0f, nullptr);
+    double tBake = sdf.bakeSeconds;
+    sdf.bake(statics, area, 2.0f, FizziksCacheDir());     // writes the cache
+    sdf.bake(statics, area, 2.0f, FizziksCacheDir());
+    printf("sdf, %d x %d samples: bake %.0f ms on %d threads, cache load %.0f ms (%s)\n", sdf.cols, sdf.rows,
+        tBake * 1e3, gJobs.threadCount(), sdf.bakeSeconds * 1e3,
+        sdf.fromCache ? "hit" : "miss");
+
+    std::mt19937 rng(2005);
+    std::uniform_real_distribution<float> pos(0.0f, side);
+    std::vector<Vector2> probes(1000000);
+    for (auto& p : probes) p = Vector2{ pos(rng), side * 0.6f + (pos(rng) - side * 0.5f) * 0.1f };
+    float sink = 0.0f;
+    auto t0 = BenchClock::now();
+    for (Vector2 p : probes) { Vector2 n; sink += sdf.sample(p, n); }
+    double tSdf = BenchSeconds(t0);
+    t0 = BenchClock::now();
+    for (Vector2 p : probes) {
+        float d = 10.0f;
+        terrain.query(Vector2{ p.x - 10.0f, p.y - 10.0f }, Vector2{ p.x + 10.0f, p.y + 10.0f },
+            [&](Vector2 a, Vector2 b) { d = fminf(d, DistanceToSegment(p, a, b)); });
+        sink += d;
+    }
+    double tBvh = BenchSeconds(t0);
+    printf("sdf lookup %.1f ns vs terrain BVH (r = 10) %.1f ns per circle (checksum %.0f)\n",
+        tSdf / probes.size() * 1e9, tBvh / probes.size() * 1e9, sink);
+}
+
+// An n-circle scene: parse its text, compile it, then load the binary form
+// and instantiate it into an empty world
+static void BenchScene(int n)
+{
+    std::mt19937 rng(2005);
+    float side = sqrtf((float)n) * 20.0f;
+    std::uniform_real_distribution<float> pos(0.0f, side);
+    std::string text = TextFormat("world gravity 0 300 bounds 0 0 %.0f %.0f\n", side, side);
+    text += "material sand mass 1 friction 0.3 radius 4 color beige\n";
+    text += "material rock mass 5 friction 0.6 radius 8 color 130 130 130 255\n";
+    text += "halfspace rock 0 0 angle 0 category ground name ground\n";
+    for (int i = 0; i < n; ++i)
+        text += TextFormat("circle %s %.2f %.2f\n", i % 8 ? "sand" : "rock", pos(rng), pos(rng));
+
+    FizziksScene scene;
+    auto t0 = BenchClock::now();
+    bool parsed = scene.parse(text.c_str(), "bench");
+    double tParse = BenchSeconds(t0);
+    scene.saveBinary("fizziks_bench.fscn");
+
+    FizziksScene binary;
+    t0 = BenchClock::now();
+    bool loaded = binary.load("fizziks_bench.fscn");
+    double tLoad = BenchSeconds(t0);
+    FizziksWorld w;
+    t0 = BenchClock::now();
+    binary.instantiate(w);
+    double tInstantiate = BenchSeconds(t0);
+    remove("fizziks_bench.fscn");
+
+    printf("scene, %d bodies (%s): parse text %.0f ms, load binary %.0f ms, instantiate %.0f ms\n",
+        (int)w.objekts.size(), parsed && loaded ? "ok" : "FAILED", tParse * 1e3, tLoad * 1e3, tInstantiate * 1e3);
+}
+
+// n circles falling into a pile, with a snapshot per step: frame arena
+// peak and the chunk allocations after the first steps (should be 0)
+static void BenchArena(int n)
+{
+    std::mt19937 rng(2005);
+    FizziksWorld w;
+    BenchPopulate(w, n, rng);
+    FizziksRenderSnapshot snap;
+
+    const int warmup = 30, steps = 300;
+    int allocations = 0;
+    for (int i = 0; i < warmup + steps; ++i) {
+        if (i == warmup) allocations = w.getFrameArena().heapAllocations();
+        w.update();
+        w.writeSnapshot(snap);
+    }
+    const FizziksFrameArena& frame = w.getFrameArena();
+    printf("frame arena, %d bodies: peak %.0f KB, capacity %.0f KB, %d chunk allocations in the first %d steps, %d after\n",
+        n, frame.peakBytes() / 1024.0, frame.capacity() / 1024.0,
+        allocations, warmup, frame.heapAllocations() - allocations);
+}
+
+// Bytes per tag for an n-circle world after one step and one snapshot
+static void BenchMemory(int n)
+{
+    size_t before[MEM_TAG_COUNT];
+    for (int t = 0; t < MEM_TAG_COUNT; ++t) before[t] = FizziksMemory::currentBytes((FizziksMemTag)t);
+    {
+        std::mt19937 rng(2005);
+        FizziksWorld w;
+        BenchPopulate(w, n, rng);
+        FizziksRenderSnapshot snap;
+        w.update();
+        w.writeSnapshot(snap);
+
+        printf("memory, %d bodies:", n);
+        for (int t = 0; t < MEM_TAG_COUNT; ++t) {
+            size_t bytes = FizziksMemory::currentBytes((FizziksMemTag)t) - before[t];
+            if (bytes) printf(" %s %.1f MB,", FizziksMemory::name((FizziksMemTag)t), bytes / (1024.0 * 1024.0));
+        }
+        printf(" %.0f bytes/body for the bodies\n",
+            (double)(FizziksMemory::currentBytes(MEM_BODIES) - before[MEM_BODIES]) / n);
+    }
+    size_t leaked = 0;
+    for (int t = 0; t < MEM_TAG_COUNT; ++t) leaked += FizziksMemory::currentBytes((FizziksMemTag)t) - before[t];
+    printf("  after the world is gone: %zu bytes left\n", leaked);
+}
+
+// n circles on a lattice, almost touching, drifting slowly without gravity:
+// full steps with and without the neighbour list, and how often it rebuilds
+static void BenchNeighbours(int n)
+{
+    int side = (int)sqrtf((float)n);
+    for (int pass = 0; pass < 2; ++pass) {
+        std::mt19937 rng(2005);
+        std::uniform_real_distribution<float> vel(-5.0f, 5.0f);
+        FizziksWorld w;
+        w.bounds = Rectangle{ -100, -100, side * 9.0f + 200, side * 9.0f + 200 };
+        w.accelerationGravity = Vector2{ 0, 0 };
+        w.useNeighbourList = pass == 1;
+        w.objekts.reserve(side * side);
+        for (int y = 0; y < side; ++y) {
+            for (int x = 0; x < side; ++x) {
+                auto* c = new FizziksCircle();
+                c->position = Vector2{ 4.5f + x * 9.0f, 4.5f + y * 9.0f };
+                c->radius = 4.0f;
+                c->velocity = Vector2{ vel(rng), vel(rng) };
+                w.add(c);
+            }
+        }
+
+        const int steps = 120;
+        w.update();
+        auto t0 = BenchClock::now();
+        for (int i = 0; i < steps; ++i) w.update();
+        double t = BenchSeconds(t0);
+        const FizziksNeighbourStats& stats = w.getNeighbourStats();
+        if (pass == 0)
+            printf("neighbours, %d bodies: grid every step %.2f ms/step\n", side * side, t / steps * 1e3);
+        else
+            printf("neighbours, %d bodies: list (skin %.0f) %.2f ms/step, %d pairs, rebuilt on %.0f%% of steps\n",
+                side * side, w.neighbourSkin, t / steps * 1e3, stats.pairs, stats.rebuildRate() * 100.0f);
+    }
+}
+
+// n circles added in random spatial order falling into a pile, never
+// sorted, then sorted up front and re-sorted as the pile mixes: ms/step,
+// pair distance and how often it sorted. Ids must still find the same
+// bodies afterwards.
+static void BenchBodyOrder(int n)
+{
+    for (int pass = 0; pass < 2; ++pass) {
+        std::mt19937 rng(2005);
+        FizziksWorld w;
+        BenchPopulate(w, n, rng);
+        w.reorderBodies = pass == 1;
+        if (w.reorderBodies) w.sortBodies();
+
+        const int warmup = 5, steps = 60;
+        for (int i = 0; i < warmup; ++i) w.update();
+        auto t0 = BenchClock::now();
+        for (int i = 0; i < steps; ++i) w.update();
+        double t = BenchSeconds(t0);
+
+        int lost = 0;
+        for (size_t i = 0; i < w.objekts.size(); i += 97) if (w.find(w.objekts[i]->id) != w.objekts[i]) ++lost;
+        const FizziksLocalityStats& stats = w.getLocalityStats();
+        printf("body order, %d bodies, %-12s %7.2f ms/step, pair distance %.0f, %lld sorts (last %.1f ms), %d ids lost\n",
+            n, pass == 0 ? "unsorted:" : "re-sorted:", t / steps * 1e3, stats.pairDistance, stats.sorts,
+            stats.sortSeconds * 1e3, lost);
+    }
+}
+
+// n 2 px particles around the spots of 300 px boulders, without and then
+// with the boulders: collision pass straight from the grid, both scenes
+static void BenchHierGrid(int n)
+{
+    for (int pass = 0; pass < 2; ++pass) {
+        std::mt19937 rng(2005);
+        FizziksWorld w;
+        float side = sqrtf((float)n) * 12.0f;
+        w.bounds = Rectangle{ 0, 0, side, side };
+        w.useNeighbourList = false;
+
+        std::vector<Vector2> boulders;
+        for (float y = 400.0f; y < side - 300.0f; y += 1500.0f)
+            for (float x = 400.0f; x < side - 300.0f; x += 1500.0f) boulders.push_back(Vector2{ x, y });
+        for (Vector2 b : boulders) {
+            if (pass == 0) break;
+            auto* c = new FizziksCircle();
+            c->position = b;
+            c->radius = 300.0f;
+            w.add(c);
+        }
+
+        std::uniform_real_distribution<float> pos(0.0f, side);
+        w.objekts.reserve(n + boulders.size());
+        for (int added = 0; added < n; ) {
+            Vector2 p{ pos(rng), pos(rng) };
+            bool inside = false;
+            for (Vector2 b : boulders) inside |= Vector2DistanceSqr(p, b) < 303.0f * 303.0f;
+            if (inside) continue;
+            auto* c = new FizziksCircle();
+            c->position = p;
+            c->radius = 2.0f;
+            w.add(c);
+            ++added;
+        }
+
+        const int steps = 10;
+        w.checkCollisions();
+        auto t0 = BenchClock::now();
+        for (int i = 0; i < steps; ++i) w.checkCollisions();
+        const FizziksGrid& g = w.getGrid();
+        int levels = 0;
+        for (int l = 0; l < g.levelCount; ++l) levels += g.inUse(l);
+        printf("hierarchical grid, %d particles + %2d boulders: %6.2f ms/step, %d levels, %d grid items\n",
+            n, pass == 0 ? 0 : (int)boulders.size(), BenchSeconds(t0) / steps * 1e3, levels, (int)g.items.size());
+    }
+}
+
+// Integrate n free-flying bodies, inline and on the job
+// system (all hardware threads here, no audio to leave room for)
+static void BenchJobs(int n)
+{
+    std::mt19937 rng(2005);
+    FizziksWorld w;
+    BenchPopulate(w, n, rng);
+    int hardware = (int)std::max(1u, std::thread::hardware_concurrency());
+    int workers = gJobs.threadCount() - 1;      // put back afterwards
+
+    double perStep[2];
+    int threads = 1;
+    for (int pass = 0; pass < 2; ++pass) {
+        gJobs.init(pass == 0 ? 0 : hardware - 1);
+        threads = gJobs.threadCount();
+        const int steps = 10;
+        auto t0 = BenchClock::now();
+        for (int i = 0; i < steps; ++i) w.integrate(w.timeStep);
+        perStep[pass] = BenchSeconds(t0) / steps;
+    }
+    gJobs.init(workers);
+    printf("jobs, integrate %d bodies: %.2f ms inline, %.2f ms on %d threads\n",
+        n, perStep[0] * 1e3, perStep[1] * 1e3, threads);
+}
+
+static void RunBenchmarks()
+{
+    gJobs.init();
+    BenchSpatialQueries(1000000);
+    BenchLayerFilter(200000);
+    BenchIntegrators(10000);
+    BenchScrub(100000);
+    BenchEmitter(65536);
+    BenchTrails(10000);
+    BenchPolygons(100000);
+    BenchTerrain(100000, 10000);
+    BenchSdf();
+    BenchJobs(1000000);
+    BenchScene(1000000);
+    BenchArena(100000);
+    BenchMemory(1000000);
+    BenchNeighbours(250000);
+    BenchBodyOrder(250000);
+    BenchHierGrid(200000);
+}
+
+//       Entry
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i) {
+        if (TextIsEqual(argv[i], "--bench")) {
+            RunBenchmarks();
+            return 0;
+        }
+        // --compile-scene in.txt out.fscn
+        if (TextIsEqual(argv[i], "--compile-scene") && i + 2 < argc) {
+            FizziksScene scene;
+            return scene.load(argv[i + 1]) && scene.saveBinary(argv[i + 2]) ? 0 : 1;
+        }
+    }
+
+    InitWindow(InitialWidth, InitialHeight, "GAME2005 – Lab 6: Kinetic Friction on Halfspace");
+    SetTargetFPS(TARGET_FPS);
+    gCircleRenderer.init();
+    gJobs.init();
+    gEmitter.init(65536);
+    gTrails.init(256, 32);
+    gSimThread.start();
+
+    // Ground, trigger zone, the 4 spheres with different mass/μ and the
+    // emitter come from the scene file; a broken file falls back to the
+    // built-in copy
+    FizziksScene scene;
+    if (!LoadScene(scene, "lab6.txt", LAB6_SCENE)) scene.parse(LAB6_SCENE, "lab6 (built-in)");
+    scene.instantiate(world, &gEmitter);
+    gGround = (FizziksHalfspace*)FindNamed("ground", HALF_SPACE);
+    gZone = (FizziksCircle*)FindNamed("zone", CIRCLE);
+    if (!gGround || !gZone) {
+        TraceLog(LOG_ERROR, "SCENE: lab6 needs a halfspace named ground and a circle named zone");
+        CloseWindow();
+        return 1;
+    }
+    SpawnPolygons();
+    SpawnTerrain();
+
+    // Terrain + ledge never move: bake them (the ground turns with its slider)
+    world.bakeSdf({ gTerrain, gLedge }, 2.0f);
+
+    syncUiFromWorld();
+    world.writeSnapshot(gSnapshots[gFront]);
+
+    while (!WindowShouldClose()) {
+        updateCamera();
+        if (IsKeyPressed(KEY_P)) gPaused = !gPaused;
+        if (IsKeyPressed(KEY_E)) gEmitter.enabled = !gEmitter.enabled;
+        if (IsKeyPressed(KEY_T)) gPipelined = !gPipelined;
+        if (IsKeyPressed(KEY_N)) {
+            auto* c = new FizziksCircle();
+            c->position = GetScreenToWorld2D(GetMousePosition(), gCamera);
+            c->radius = 12.0f;
+            c->baseColor = GOLD; c->color = GOLD;
+            if (!world.commands.push(FizziksCommand::Add(c))) delete c;
+        }
+        if (IsKeyPressed(KEY_X) && gUi.hoverId >= 0) world.commands.push(FizziksCommand::Remove((unsigned int)gUi.hoverId));
+        if (IsMouseButtonDown(MOUSE_BUTTON_MIDDLE)) gEmitter.position = GetScreenToWorld2D(GetMousePosition(), gCamera);
+
+        // Sync point: the step kicked last frame is done and its snapshot
+        // becomes the one to draw. The world is idle until the next kick.
+        if (gSimThread.wait()) {
+            gFront = 1 - gFront;
+            afterStep();
+        }
+        applyUi();
+        updateHover();
+
+        if (world.scrubbing()) {
+            // Catch up with the time slider, a few ms per frame
+            world.continueScrub(0.008);
+            if (!world.scrubbing()) syncUiFromWorld();      // replayed commands may have moved them
+            gInZone = world.contactCount(gZone);
+            world.writeSnapshot(gSnapshots[gFront]);
+        }
+        else if (!gPaused) {
+            world.discardFuture();
+            if (gPipelined) {
+                gSimThread.kick(StepIntoBackSnapshot);
+            }
+            else {
+                world.update();
+                afterStep();
+                world.writeSnapshot(gSnapshots[gFront]);
+            }
+        }
+        else {
+            world.applyCommands();                      // slider edits show while paused
+            world.writeSnapshot(gSnapshots[gFront]);
+        }
 
-        world.update();
         drawFrame();
     }
 
+    gSimThread.stop();
+    gCircleRenderer.unload();
     CloseWindow();
     return 0;
 }
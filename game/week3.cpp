@@ -6,6 +6,7 @@
 #include "raygui.h"
 
 #include "game.h"
+#include "quadratic.h"
 
 //  Simulation Types
 
@@ -54,14 +55,63 @@ float gravityAngle = 90.0f;
 
 PhysicsBody bird = { {200.0f, 500.0f}, {0.0f, 0.0f}, 0.0f, 1.0f, false };
 
+// Decimated trail in a ring buffer: a sample only becomes a vertex once the
+// line from the last vertex stops covering the samples since then (within
+// TRAIL_TOLERANCE px), so straight stretches cost nothing. Once full, the
+// newest vertex overwrites the oldest.
 #define TRAIL_MAX 300
+#define TRAIL_PENDING 32
+#define TRAIL_TOLERANCE 0.5f
 Vector2 trail[TRAIL_MAX];
+int trailHead = 0;      // next slot to write
 int trailCount = 0;
+Vector2 trailPending[TRAIL_PENDING];
+int trailPendingCount = 0;
 
-static inline void ResetTrail() { trailCount = 0; }
-static inline void PushTrail(Vector2 p) { if (trailCount < TRAIL_MAX) trail[trailCount++] = p; }
+static inline void ResetTrail() { trailHead = 0; trailCount = 0; trailPendingCount = 0; }
 
+static inline void PushTrailVertex(Vector2 p)
+{
+    trail[trailHead] = p;
+    trailHead = (trailHead + 1) % TRAIL_MAX;
+    if (trailCount < TRAIL_MAX) ++trailCount;
+}
+
+static inline float DistanceToSegment(Vector2 p, Vector2 a, Vector2 b)
+{
+    Vector2 ab = Vector2Subtract(b, a);
+    float len2 = Vector2DotProduct(ab, ab);
+    float t = len2 > 0.0f ? Clamp(Vector2DotProduct(Vector2Subtract(p, a), ab) / len2, 0.0f, 1.0f) : 0.0f;
+    return Vector2Distance(p, Vector2Add(a, Vector2Scale(ab, t)));
+}
 
+static inline void PushTrail(Vector2 p)
+{
+    if (trailCount == 0) { PushTrailVertex(p); return; }
+
+    // Does last vertex -> p still cover every pending sample?
+    Vector2 a = trail[(trailHead - 1 + TRAIL_MAX) % TRAIL_MAX];
+    bool covered = trailPendingCount < TRAIL_PENDING;
+    for (int k = 0; covered && k < trailPendingCount; ++k)
+        covered = DistanceToSegment(trailPending[k], a, p) <= TRAIL_TOLERANCE;
+
+    if (!covered) {
+        PushTrailVertex(trailPending[trailPendingCount - 1]);
+        trailPendingCount = 0;
+    }
+    trailPending[trailPendingCount++] = p;
+}
+
+// Predicted arc while idle, up to the time the bird would leave the screen
+// margin. Integrate() moves velocity before position, which gives exactly
+//     p(t) = p0 + v0 t + 1/2 g t (t + dt)     at t = n dt
+// so the arc follows the flight. Rebuilt only when the launch or gravity
+// sliders change, the frame time changes by a millisecond, or the window
+// is resized.
+#define ARC_POINTS 64
+Vector2 arc[ARC_POINTS];
+int arcCount = 0;
+float arcInputs[9] = { -1.0f, -1.0f, -1.0f, -1.0f, -1.0f, -1.0f, -1.0f, -1.0f, -1.0f };
 
 static inline void UpdateGravityFromUI()
 {
@@ -83,6 +133,43 @@ static inline void Launch()
     ResetTrail();
 }
 
+static void UpdateArcPreview()
+{
+    // The screen size sets the end margin, so a resize counts too
+    float dt = roundf(sim.deltaTime * 1000.0f) / 1000.0f;
+    float inputs[9] = { launchX, launchY, launchAngleDeg, launchSpeed, sim.gravity.x, sim.gravity.y,
+        (float)GetScreenWidth(), (float)GetScreenHeight(), dt };
+    bool same = true;
+    for (int i = 0; i < 9; ++i) if (inputs[i] != arcInputs[i]) same = false;
+    if (same) return;
+    for (int i = 0; i < 9; ++i) arcInputs[i] = inputs[i];
+
+    // p(t) = p0 + b t + h t^2 with the Euler lead folded into b
+    float a = DEG2RAD * launchAngleDeg;
+    Vector2 p0 = { launchX, launchY };
+    Vector2 v0 = { launchSpeed * cosf(a), -launchSpeed * sinf(a) };
+    Vector2 h = { 0.5f * sim.gravity.x, 0.5f * sim.gravity.y };
+    Vector2 b = { v0.x + h.x * dt, v0.y + h.y * dt };
+
+    // Same margin as the deactivation test in update()
+    float tEnd = 20.0f;
+    float lo[2] = { -50.0f, -50.0f };
+    float hi[2] = { (float)GetScreenWidth() + 50.0f, (float)GetScreenHeight() + 50.0f };
+    float pa[2] = { h.x, h.y }, pb[2] = { b.x, b.y }, pc[2] = { p0.x, p0.y };
+    for (int axis = 0; axis < 2; ++axis) {
+        float t = FirstPositiveRoot(pa[axis], pb[axis], pc[axis] - lo[axis]);
+        if (t > 0.0f && t < tEnd) tEnd = t;
+        t = FirstPositiveRoot(pa[axis], pb[axis], pc[axis] - hi[axis]);
+        if (t > 0.0f && t < tEnd) tEnd = t;
+    }
+
+    arcCount = ARC_POINTS;
+    for (int i = 0; i < ARC_POINTS; ++i) {
+        float t = tEnd * i / (ARC_POINTS - 1);
+        arc[i] = { p0.x + b.x * t + h.x * t * t, p0.y + b.y * t + h.y * t * t };
+    }
+}
+
 //Update & Draw 
 
 static void update()
@@ -153,6 +240,9 @@ static void draw()
         Vector2 tip = { launchX + v0x * s, launchY + v0y * s };
         DrawCircleV(start, 8.0f, GREEN);
         DrawLineEx(start, tip, 4.0f, RED);
+
+        UpdateArcPreview();
+        DrawLineStrip(arc, arcCount, Color{ 160, 160, 160, 200 });
     }
 
     // Gravity vector visualization
@@ -162,10 +252,13 @@ static void draw()
     DrawLineEx(gStart, gTip, 3.0f, YELLOW);
     DrawText("g", 44, 22, 18, YELLOW);
 
-    // Trail + bird
-    Color trailCol = { 160, 160, 160, 200 };
-    for (int i = 0; i < trailCount; ++i)
-        DrawCircleV(trail[i], 2.0f, trailCol);
+    // Trail (oldest vertex first, then the newest sample) as one strip + bird
+    static Vector2 strip[TRAIL_MAX + 1];
+    int oldest = (trailHead - trailCount + TRAIL_MAX) % TRAIL_MAX;
+    int n = 0;
+    for (int i = 0; i < trailCount; ++i) strip[n++] = trail[(oldest + i) % TRAIL_MAX];
+    if (trailPendingCount > 0) strip[n++] = trailPending[trailPendingCount - 1];
+    if (n >= 2) DrawLineStrip(strip, n, Color{ 160, 160, 160, 200 });
 
     if (bird.active) DrawCircleV(bird.pos, 10.0f, RED);
 